@@ -0,0 +1,86 @@
+// lookup/insert/erase time and heap bytes of btree_map against the red-black tree map
+// g++ -O2 -std=c++14 -I../src btree_vs_rbtree.cpp -o btree_vs_rbtree
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+
+#include "map.hpp"
+#include "btree_map.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+const int N = 10000000;
+
+//统计当前从堆上申请的字节数
+size_t heap_bytes = 0;
+
+void *operator new(size_t n) {
+	size_t *p = static_cast<size_t *>(malloc(n + sizeof(size_t)));
+	if (p == nullptr) throw std::bad_alloc();
+	*p = n;
+	heap_bytes += n;
+	return p + 1;
+}
+
+void operator delete(void *p) noexcept {
+	if (p == nullptr) return;
+	size_t *q = static_cast<size_t *>(p) - 1;
+	heap_bytes -= *q;
+	free(q);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	operator delete(p);
+}
+
+unsigned next_rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return reed >> 1;
+}
+
+double seconds(Clock::time_point st) {
+	return std::chrono::duration<double>(Clock::now() - st).count();
+}
+
+int *keys;
+
+template<class Map>
+void bench(const char *name) {
+	size_t base = heap_bytes;
+	Map *mp = new Map;
+	Clock::time_point st = Clock::now();
+	for (int i = 0; i < N; i++) mp->insert(sjtu::pair<int, int>(keys[i], i));
+	double ins = seconds(st);
+	size_t bytes = heap_bytes - base;
+
+	st = Clock::now();
+	long long sum = 0;
+	for (int i = 0; i < N; i++) sum += mp->find(keys[(i * 7919ll) % N])->second;
+	double look = seconds(st);
+
+	st = Clock::now();
+	for (int i = 0; i < N / 2; i++) mp->erase(mp->find(keys[i]));
+	double era = seconds(st);
+	delete mp;
+
+	printf("%-8s insert %6.0f ns   find %6.0f ns   erase %6.0f ns   %5.1f bytes/entry   (%lld)\n", name,
+	       ins * 1e9 / N, look * 1e9 / N, era * 2e9 / N, (double) bytes / N, sum);
+}
+
+int main() {
+	keys = static_cast<int *>(malloc(sizeof(int) * N));
+	//随机打乱的 0..N-1,没有重复的key
+	for (int i = 0; i < N; i++) keys[i] = i;
+	for (int i = N - 1; i > 0; i--) {
+		int j = next_rand() % (i + 1), t = keys[i];
+		keys[i] = keys[j];
+		keys[j] = t;
+	}
+	bench<sjtu::map<int, int> >("rbtree");
+	bench<sjtu::btree_map<int, int> >("btree");
+	free(keys);
+	return 0;
+}
@@ -0,0 +1,62 @@
+// build a map from sorted keys: n inserts, n hinted inserts at end() and from_sorted, and the copy constructor
+// g++ -O2 -std=c++14 -I../src bulk_load.cpp -o bulk_load
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+
+#include "map.hpp"
+
+typedef std::chrono::steady_clock Clock;
+typedef sjtu::map<int, int> Map;
+
+const int N = 10000000;
+
+double seconds(Clock::time_point st) {
+	return std::chrono::duration<double>(Clock::now() - st).count();
+}
+
+//按顺序遍历一遍,看节点在内存中的排布
+long long scan(const Map &mp, double &t) {
+	Clock::time_point st = Clock::now();
+	long long sum = 0;
+	for (Map::const_iterator it = mp.cbegin(); it != mp.cend(); ++it) sum += it->second;
+	t = seconds(st);
+	return sum;
+}
+
+int main() {
+	std::vector<sjtu::pair<const int, int> > v;
+	v.reserve(N);
+	for (int i = 0; i < N; i++) v.push_back(sjtu::pair<const int, int>(i, i));
+
+	Clock::time_point st = Clock::now();
+	Map *a = new Map;
+	for (int i = 0; i < N; i++) a->insert(v[i]);
+	double ins = seconds(st);
+
+	st = Clock::now();
+	Map *h = new Map;
+	for (int i = 0; i < N; i++) h->insert(h->cend(), v[i]);
+	double hinted = seconds(st);
+
+	st = Clock::now();
+	Map *b = new Map(Map::from_sorted(v.begin(), v.end()));
+	double bulk = seconds(st);
+
+	st = Clock::now();
+	Map *c = new Map(*a);
+	double copy = seconds(st);
+
+	double sa, sb;
+	long long sum = scan(*a, sa) + scan(*b, sb);
+	printf("insert      %6.1f ns/entry   scan %5.1f ns/entry\n", ins * 1e9 / N, sa * 1e9 / N);
+	printf("hinted      %6.1f ns/entry\n", hinted * 1e9 / N);
+	printf("from_sorted %6.1f ns/entry   scan %5.1f ns/entry\n", bulk * 1e9 / N, sb * 1e9 / N);
+	printf("copy        %6.1f ns/entry   (%lld)\n", copy * 1e9 / N, sum);
+	delete a;
+	delete h;
+	delete b;
+	delete c;
+	return 0;
+}
@@ -0,0 +1,126 @@
+// lookups per second with R reader threads and one writer: concurrent_map against map behind a lock
+// g++ -O2 -std=c++14 -pthread -I../src concurrent_readers.cpp -o concurrent_readers
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "map.hpp"
+#include "concurrent_map.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+const int N = 1000000;
+const double SECONDS = 1.0;
+
+std::atomic<int> sink(0);
+
+unsigned step(unsigned &seed) {
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 1;
+}
+
+//读写锁保护的map
+struct Locked {
+	sjtu::map<int, int> mp;
+	mutable std::shared_timed_mutex lock;
+
+	bool get(int key, int &out) const {
+		std::shared_lock<std::shared_timed_mutex> guard(lock);
+		sjtu::map<int, int>::const_iterator it = mp.find(key);
+		if (it == mp.cend()) return false;
+		out = it->second;
+		return true;
+	}
+
+	void assign(int key, int value) {
+		std::unique_lock<std::shared_timed_mutex> guard(lock);
+		mp[key] = value;
+	}
+
+	void erase(int key) {
+		std::unique_lock<std::shared_timed_mutex> guard(lock);
+		sjtu::map<int, int>::iterator it = mp.find(key);
+		if (it != mp.end()) mp.erase(it);
+	}
+};
+
+struct Lockfree {
+	sjtu::concurrent_map<int, int> mp;
+
+	bool get(int key, int &out) const {
+		return mp.get(key, out);
+	}
+
+	void assign(int key, int value) {
+		mp.assign(key, value);
+	}
+
+	void erase(int key) {
+		mp.erase(key);
+	}
+};
+
+//所有线程都跑到同一个截止时间;writes为false时写者不动
+template<class M>
+void run(const char *name, M &m, int readers, bool writes) {
+	Clock::time_point deadline = Clock::now() + std::chrono::milliseconds((int) (SECONDS * 1000));
+	std::vector<long long> reads(readers);
+	long long written = 0;
+	std::vector<std::thread> th;
+	for (int r = 0; r < readers; r++) {
+		th.push_back(std::thread([&m, &reads, deadline, r]() {
+			unsigned seed = 1727417277u + r;
+			long long cnt = 0;
+			int v, hit = 0;
+			while (Clock::now() < deadline) {
+				for (int i = 0; i < 64; i++) hit += m.get(step(seed) % (N * 2), v);
+				cnt += 64;
+			}
+			reads[r] = cnt;
+			sink += hit;
+		}));
+	}
+	unsigned seed = 12345;
+	while (Clock::now() < deadline) {
+		if (!writes) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			continue;
+		}
+		//读写锁下写者可能一直等到读者都结束
+		for (int i = 0; i < 16; i++, written++) {
+			unsigned x = step(seed);
+			if (x & 1) m.assign(x % (N * 2), (int) x);
+			else m.erase(x % (N * 2));
+		}
+	}
+	for (int r = 0; r < readers; r++) th[r].join();
+	long long total = 0;
+	for (int r = 0; r < readers; r++) total += reads[r];
+	printf("%-24s readers %2d   %6.2f M lookups/s (%5.2f M per reader)   %6.3f M writes/s\n",
+	       name, readers, total / SECONDS / 1e6, readers ? total / SECONDS / 1e6 / readers : 0.0, written / SECONDS / 1e6);
+}
+
+int main() {
+	printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	Locked locked;
+	Lockfree lockfree;
+	unsigned seed = 1;
+	for (int i = 0; i < N; i++) {
+		unsigned x = step(seed);
+		locked.assign(x % (N * 2), i);
+		lockfree.assign(x % (N * 2), i);
+	}
+	for (int w = 0; w < 2; w++) {
+		printf(w ? "one writer:\n" : "readers only:\n");
+		for (int r = w ? 0 : 1; r <= 8; r = r ? r * 2 : 1) {
+			run("map + shared_timed_mutex", locked, r, w);
+			run("concurrent_map", lockfree, r, w);
+		}
+	}
+	return 0;
+}
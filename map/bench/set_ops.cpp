@@ -0,0 +1,64 @@
+// union/intersection/difference by split and join against inserting/erasing one element at a time
+// g++ -O2 -std=c++14 -pthread -I../src set_ops.cpp -o set_ops
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+
+#include "map.hpp"
+
+typedef std::chrono::steady_clock Clock;
+typedef sjtu::map<int, int> Map;
+
+const int N = 4000000;
+
+unsigned next_rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return reed >> 1;
+}
+
+double seconds(Clock::time_point st) {
+	return std::chrono::duration<double>(Clock::now() - st).count();
+}
+
+void bench(const Map &a, const Map &b) {
+	Map u(a), x(a), d(a), u1(a), d1(a), x1;
+	Clock::time_point st = Clock::now();
+	u.union_with(b);
+	double tu = seconds(st);
+	st = Clock::now();
+	x.intersect_with(b);
+	double tx = seconds(st);
+	st = Clock::now();
+	d.difference_with(b);
+	double td = seconds(st);
+
+	//逐个插入/删除
+	st = Clock::now();
+	for (Map::const_iterator it = b.cbegin(); it != b.cend(); ++it) u1.insert(*it);
+	double su = seconds(st);
+	st = Clock::now();
+	for (Map::const_iterator it = b.cbegin(); it != b.cend(); ++it)
+		if (a.count(it->first)) x1.insert(*a.find(it->first));
+	double sx = seconds(st);
+	st = Clock::now();
+	for (Map::const_iterator it = b.cbegin(); it != b.cend(); ++it) {
+		Map::iterator p = d1.find(it->first);
+		if (p != d1.end()) d1.erase(p);
+	}
+	double sd = seconds(st);
+	printf("n = %8d  m = %8d   union %7.1f ms (%7.1f)   intersect %7.1f ms (%7.1f)   difference %7.1f ms (%7.1f)\n",
+	       (int) a.size(), (int) b.size(), tu * 1e3, su * 1e3, tx * 1e3, sx * 1e3, td * 1e3, sd * 1e3);
+	if (u.size() != u1.size() || x.size() != x1.size() || d.size() != d1.size()) printf("wrong result\n");
+}
+
+int main() {
+	printf("(in brackets: one element at a time)\n");
+	for (int m = N; m >= N / 1000; m /= 10) {
+		Map a, b;
+		for (int i = 0; i < N; i++) a[next_rand() % (N * 2)] = i;
+		for (int i = 0; i < m; i++) b[next_rand() % (N * 2)] = i;
+		bench(a, b);
+	}
+	return 0;
+}
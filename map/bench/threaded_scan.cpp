@@ -0,0 +1,50 @@
+// full forward/backward scans of map against threaded_map
+// g++ -O2 -std=c++14 -I../src threaded_scan.cpp -o threaded_scan
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+
+#include "map.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+
+unsigned next_rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return reed >> 1;
+}
+
+double seconds(Clock::time_point st) {
+	return std::chrono::duration<double>(Clock::now() - st).count();
+}
+
+//shuffled为真时按随机顺序插入,节点在内存中是乱序的
+template<class Map>
+void bench(const char *name, int n, int rounds, bool shuffled) {
+	Map mp;
+	for (int i = 0; i < n; i++) mp[shuffled ? next_rand() : i] = i;
+	long long sum = 0;
+	Clock::time_point st = Clock::now();
+	for (int r = 0; r < rounds; r++)
+		for (typename Map::const_iterator it = mp.cbegin(); it != mp.cend(); ++it) sum += it->second;
+	double fwd = seconds(st);
+	st = Clock::now();
+	for (int r = 0; r < rounds; r++) {
+		typename Map::const_iterator it = mp.cend();
+		while (it != mp.cbegin()) sum -= (--it)->second;
+	}
+	double bwd = seconds(st);
+	printf("%8d %s %-12s ++ %5.1f ns   -- %5.1f ns   (%lld)\n", n, shuffled ? "shuffled  " : "sequential", name,
+	       fwd * 1e9 / rounds / n, bwd * 1e9 / rounds / n, sum);
+}
+
+int main() {
+	int sizes[][2] = {{10000, 1000}, {2000000, 10}};
+	for (int i = 0; i < 2; i++)
+		for (int shuffled = 1; shuffled >= 0; shuffled--) {
+			bench<sjtu::map<unsigned, int> >("map", sizes[i][0], sizes[i][1], shuffled);
+			bench<sjtu::threaded_map<unsigned, int> >("threaded_map", sizes[i][0], sizes[i][1], shuffled);
+		}
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "btree_map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//没有默认构造函数和赋值,统计存活的个数
+class Integer {
+public:
+	static int counter;
+	int val;
+	Integer(int val) : val(val) { counter++; }
+	Integer(const Integer &rhs) : val(rhs.val) { counter++; }
+	Integer &operator=(const Integer &rhs) = delete;
+	~Integer() { counter--; }
+};
+
+int Integer::counter = 0;
+
+struct Greater {
+	bool operator()(const Integer &a, const Integer &b) const {
+		return a.val > b.val;
+	}
+};
+
+template<class Map>
+bool same(const Map &mp, const std::map<int, int> &std_mp)
+{
+	if (mp.size() != std_mp.size()) return false;
+	std::map<int, int>::const_iterator std_it = std_mp.begin();
+	for (typename Map::const_iterator it = mp.cbegin(); it != mp.cend(); ++it, ++std_it) {
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+	}
+	return std_it == std_mp.end();
+}
+
+bool testint()
+{
+	sjtu::btree_map<int, int> mp;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 300000; i++) {
+		int op = rand() % 5, key = rand() % (i < 150000 ? 100000 : 3000);
+		if (op < 2) {
+			sjtu::pair<sjtu::btree_map<int, int>::iterator, bool> res = mp.insert(sjtu::pair<int, int>(key, i));
+			bool ok = std_mp.insert(std::make_pair(key, i)).second;
+			if (res.second != ok || res.first->first != key || res.first->second != std_mp[key]) return false;
+		} else if (op == 2) {
+			mp[key] += i;
+			std_mp[key] += i;
+		} else if (op == 3) {
+			sjtu::btree_map<int, int>::iterator it = mp.find(key);
+			if ((it == mp.end()) != (std_mp.count(key) == 0)) return false;
+			if (it != mp.end()) mp.erase(it);
+			std_mp.erase(key);
+		} else {
+			if (mp.count(key) != std_mp.count(key)) return false;
+			try {
+				if (mp.at(key) != std_mp.at(key)) return false;
+			} catch (sjtu::index_out_of_bound) {
+				if (std_mp.count(key)) return false;
+			}
+		}
+		if (i % 50000 == 0 && !same(mp, std_mp)) return false;
+	}
+	if (!same(mp, std_mp)) return false;
+
+	//复制之后互不影响
+	sjtu::btree_map<int, int> copy(mp);
+	copy.clear();
+	copy = mp;
+	while (!mp.empty()) mp.erase(mp.begin());
+	if (!same(copy, std_mp) || mp.begin() != mp.end()) return false;
+
+	//反向遍历
+	sjtu::btree_map<int, int>::iterator it = copy.end();
+	for (std::map<int, int>::reverse_iterator std_it = std_mp.rbegin(); std_it != std_mp.rend(); ++std_it) {
+		--it;
+		if (it->first != std_it->first) return false;
+	}
+	if (it != copy.begin()) return false;
+	try {
+		--it;
+		return false;
+	} catch (sjtu::invalid_iterator) {}
+	try {
+		copy.erase(mp.end());
+		return false;
+	} catch (sjtu::invalid_iterator) {}
+	return true;
+}
+
+bool testclass()
+{
+	{
+		sjtu::btree_map<Integer, std::string, Greater> mp;
+		std::map<int, std::string, std::greater<int> > std_mp;
+		for (int i = 0; i < 100000; i++) {
+			int key = rand() % 20000;
+			if (rand() % 3) {
+				std::string v = std::to_string(i);
+				mp.insert(sjtu::pair<Integer, std::string>(Integer(key), v));
+				std_mp.insert(std::make_pair(key, v));
+			} else {
+				sjtu::btree_map<Integer, std::string, Greater>::iterator it = mp.find(Integer(key));
+				if (it != mp.end()) mp.erase(it);
+				std_mp.erase(key);
+			}
+		}
+		if (mp.size() != std_mp.size()) return false;
+		std::map<int, std::string, std::greater<int> >::iterator std_it = std_mp.begin();
+		for (sjtu::btree_map<Integer, std::string, Greater>::iterator it = mp.begin(); it != mp.end(); it++, std_it++) {
+			if (it->first.val != std_it->first || (*it).second != std_it->second) return false;
+		}
+		sjtu::btree_map<Integer, std::string, Greater> copy(mp);
+		if (Integer::counter < 2 * (int) std_mp.size()) return false;
+	}
+	return Integer::counter == 0;
+}
+
+int main()
+{
+	std::cout << (testint() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testclass() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//数一下从堆上申请了多少次
+long long allocations = 0;
+
+void *operator new(size_t n) {
+	allocations++;
+	void *p = malloc(n);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+//记录分配器申请了多少个节点
+long long node_allocs = 0, node_frees = 0;
+
+template<class T>
+struct CountingAllocator {
+	typedef T value_type;
+	CountingAllocator() {}
+	template<class U>
+	CountingAllocator(const CountingAllocator<U> &) {}
+	T *allocate(size_t n) {
+		node_allocs++;
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T *p, size_t n) {
+		node_frees++;
+		std::allocator<T>().deallocate(p, n);
+	}
+};
+
+//没有默认构造函数,也不能赋值;记下构造和析构的次数
+long long constructed = 0, destroyed = 0;
+
+class Key {
+	int v;
+public:
+	explicit Key(int _v) : v(_v) {
+		constructed++;
+	}
+	Key(const Key &other) : v(other.v) {
+		constructed++;
+	}
+	Key &operator=(const Key &) = delete;
+	~Key() {
+		destroyed++;
+	}
+	int get() const {
+		return v;
+	}
+	bool operator<(const Key &other) const {
+		return v < other.v;
+	}
+};
+
+class Value {
+	long long v;
+public:
+	explicit Value(long long _v) : v(_v) {
+		constructed++;
+	}
+	Value(const Value &other) : v(other.v) {
+		constructed++;
+	}
+	Value &operator=(const Value &) = delete;
+	~Value() {
+		destroyed++;
+	}
+	long long get() const {
+		return v;
+	}
+};
+
+typedef sjtu::map<Key, Value, std::less<Key>, CountingAllocator<sjtu::pair<const Key, Value> > > Map;
+typedef sjtu::pair<const Key, Value> Pair;
+
+long long live() {
+	return constructed - destroyed;
+}
+
+bool same(const Map &mp, const std::map<int, long long> &std_map)
+{
+	if (mp.size() != std_map.size()) return false;
+	std::map<int, long long>::const_iterator it = std_map.begin();
+	for (Map::const_iterator jt = mp.cbegin(); jt != mp.cend(); ++jt, ++it)
+		if (jt->first.get() != it->first || jt->second.get() != it->second) return false;
+	return true;
+}
+
+//end_node不构造数据,空的map只申请end_node
+bool testempty()
+{
+	{
+		long long before = allocations;
+		Map a;
+		if (allocations - before != 1) return false;
+		Map b(a), c;
+		c = a;
+		a.clear();
+		Map &self = c;
+		c = self;
+		if (constructed != 0 || node_allocs != 0 || !a.empty() || b.begin() != b.end()) return false;
+	}
+	return constructed == 0 && destroyed == 0;
+}
+
+//每次插入只申请一个节点,数据就在节点里
+bool testalloc()
+{
+	Map mp;
+	long long before = allocations, nodes = node_allocs;
+	int inserted = 0;
+	for (int i = 0; i < 5000; i++) {
+		Pair p(Key(rand() % 10000), Value(i));
+		//临时的pair不算在map里
+		long long now = allocations;
+		if (mp.insert(p).second) {
+			inserted++;
+			if (allocations - now != 1) return false;
+		} else if (allocations != now) return false;
+	}
+	return node_allocs - nodes == inserted && allocations - before == inserted &&
+	       live() == 2 * (long long) mp.size();
+}
+
+//插入、删除、清空、复制之后,活着的Key和Value正好是map里的两倍
+bool testbalance()
+{
+	{
+		Map mp;
+		std::map<int, long long> std_map;
+		for (int i = 0; i < 20000; i++) {
+			int key = rand() % 3000;
+			if (rand() % 3) {
+				if (mp.insert(Pair(Key(key), Value(i))).second) std_map.insert(std::make_pair(key, (long long) i));
+			} else {
+				Map::iterator it = mp.find(Key(key));
+				if ((it == mp.end()) != !std_map.count(key)) return false;
+				if (it != mp.end()) {
+					mp.erase(it);
+					std_map.erase(key);
+				}
+			}
+			if (live() != 2 * (long long) mp.size()) return false;
+		}
+		if (!same(mp, std_map)) return false;
+
+		Map copy(mp);
+		if (live() != 4 * (long long) mp.size() || !same(copy, std_map)) return false;
+		Map assigned;
+		assigned.insert(Pair(Key(-1), Value(-1)));
+		assigned = copy;
+		if (live() != 6 * (long long) mp.size() || !same(assigned, std_map)) return false;
+		Map &self = assigned;
+		assigned = self;
+		copy.clear();
+		if (live() != 4 * (long long) mp.size() || !copy.empty()) return false;
+		mp.clear();
+		if (live() != 2 * (long long) assigned.size()) return false;
+		for (int i = 0; i < 100; i++) mp.insert(Pair(Key(i), Value(i)));
+		if (live() != 2 * (long long) (assigned.size() + 100)) return false;
+	}
+	return live() == 0 && node_allocs == node_frees;
+}
+
+int main()
+{
+	std::cout << (testempty() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testalloc() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testbalance() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+typedef sjtu::map<int, int> Map;
+typedef sjtu::pair<const int, int> Value;
+
+//检查红黑树的性质,返回黑高,不满足返回-1
+template<class Node>
+int check(const Node *t, const Node *fa, size_t &cnt) {
+	if (t == nullptr) return 1;
+	cnt++;
+	if (t->fa != fa) return -1;
+	if (t->color == 0 && ((t->left && t->left->color == 0) || (t->right && t->right->color == 0))) return -1;
+	int l = check(t->left, t, cnt), r = check(t->right, t, cnt);
+	if (l < 0 || l != r) return -1;
+	return l + (t->color == 1);
+}
+
+template<class M>
+bool valid(const M &mp) {
+	size_t cnt = 0;
+	if (mp.mp.root && mp.mp.root->color != 1) return false;
+	return check(mp.mp.root, (decltype(mp.mp.root)) nullptr, cnt) >= 0 && cnt == mp.size();
+}
+
+template<class M>
+int height(const typename M::NODE *t) {
+	if (t == nullptr) return 0;
+	int l = height<M>(t->left), r = height<M>(t->right);
+	return (l > r ? l : r) + 1;
+}
+
+bool testbuild()
+{
+	for (int n = 0; n < 600; n++) {
+		std::vector<Value> v;
+		for (int i = 0; i < n; i++) v.push_back(Value(i * 3, i));
+		Map mp = Map::from_sorted(v.begin(), v.end());
+		if (!valid(mp) || mp.size() != (size_t) n) return false;
+		//完全平衡:高度是 floor(log2 n) + 1
+		int h = 0;
+		while ((1 << h) <= n) h++;
+		if (height<Map>(mp.mp.root) != h) return false;
+		int i = 0;
+		for (Map::iterator it = mp.begin(); it != mp.end(); ++it, i++)
+			if (it->first != i * 3 || it->second != i) return false;
+		if (i != n) return false;
+		if (n && ((--mp.end())->first != (n - 1) * 3 || mp.begin()->first != 0)) return false;
+	}
+
+	//建好之后继续插入删除
+	std::vector<Value> v;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 100000; i++) {
+		v.push_back(Value(i * 2, i));
+		std_mp[i * 2] = i;
+	}
+	Map mp = Map::from_sorted(v.begin(), v.end());
+	if (!valid(mp)) return false;
+	for (int i = 0; i < 100000; i++) {
+		int key = rand() % 300000;
+		if (rand() % 2) {
+			mp[key] = i;
+			std_mp[key] = i;
+		} else {
+			Map::iterator it = mp.find(key);
+			if (it != mp.end()) mp.erase(it);
+			std_mp.erase(key);
+		}
+	}
+	if (!valid(mp) || mp.size() != std_mp.size()) return false;
+	std::map<int, int>::iterator std_it = std_mp.begin();
+	for (Map::iterator it = mp.begin(); it != mp.end(); ++it, ++std_it)
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+
+	//不严格递增就抛异常
+	std::vector<Value> bad;
+	for (int i = 0; i < 100; i++) bad.push_back(Value(i == 50 ? 48 : i, i));
+	try {
+		Map::from_sorted(bad.begin(), bad.end());
+		return false;
+	} catch (sjtu::runtime_error &) {}
+	bad.clear();
+	for (int i = 0; i < 100; i++) bad.push_back(Value(i == 50 ? 49 : i, i));
+	try {
+		Map::from_sorted(bad.begin(), bad.end());
+		return false;
+	} catch (sjtu::runtime_error &) {}
+	return true;
+}
+
+bool testcopy()
+{
+	Map mp;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 200000; i++) {
+		int key = rand() % 100000;
+		mp[key] = i;
+		std_mp[key] = i;
+	}
+	Map copy(mp), assigned;
+	assigned[1] = 1;
+	assigned = mp;
+	if (!valid(copy) || !valid(assigned)) return false;
+	if (height<Map>(copy.mp.root) != height<Map>(mp.mp.root)) return false;
+	Map::iterator a = copy.begin(), b = assigned.begin();
+	for (std::map<int, int>::iterator it = std_mp.begin(); it != std_mp.end(); ++it, ++a, ++b)
+		if (a->first != it->first || a->second != it->second || b->first != it->first || b->second != it->second)
+			return false;
+	if (a != copy.end() || b != assigned.end()) return false;
+
+	//移动
+	Map moved(std::move(copy));
+	if (!copy.empty() || moved.size() != std_mp.size() || !valid(moved)) return false;
+	copy = std::move(moved);
+	if (!moved.empty() || copy.size() != std_mp.size()) return false;
+	copy[-1] = 0;
+	moved[-1] = 0;
+	return valid(copy) && valid(moved) && copy.size() == std_mp.size() + 1 && moved.size() == 1;
+}
+
+bool testranked()
+{
+	typedef sjtu::ranked_map<int, int> RMap;
+	std::vector<sjtu::pair<const int, int> > v;
+	for (int i = 0; i < 5000; i++) v.push_back(sjtu::pair<const int, int>(i * 2, i));
+	RMap mp = RMap::from_sorted(v.begin(), v.end());
+	for (int i = 0; i < 5000; i++) {
+		if (mp.select(i)->first != i * 2 || mp.rank(i * 2 + 1) != (size_t) i + 1) return false;
+	}
+	RMap copy(mp);
+	mp.erase(mp.find(0));
+	return copy.select(0)->first == 0 && mp.select(0)->first == 2 && copy.end() - copy.begin() == 5000;
+}
+
+int main()
+{
+	std::cout << (testbuild() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testcopy() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testranked() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//数一下从堆上申请了多少次
+long long allocations = 0;
+
+void *operator new(size_t n) {
+	allocations++;
+	void *p = malloc(n);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+//只按第一个字母比较
+struct Initial {
+	char c;
+};
+
+struct Less {
+	typedef void is_transparent;
+
+	bool operator()(const std::string &a, const std::string &b) const {
+		return a < b;
+	}
+
+	bool operator()(const std::string &a, const char *b) const {
+		return strcmp(a.c_str(), b) < 0;
+	}
+
+	bool operator()(const char *a, const std::string &b) const {
+		return strcmp(a, b.c_str()) < 0;
+	}
+
+	bool operator()(const std::string &a, Initial b) const {
+		return a[0] < b.c;
+	}
+
+	bool operator()(Initial a, const std::string &b) const {
+		return a.c < b[0];
+	}
+};
+
+//很长的key,std::string一定要在堆上申请
+std::string make_key(int i) {
+	std::string s = "request-router-path-";
+	s += (char) ('a' + i % 26);
+	for (; i; i /= 10) s += (char) ('0' + i % 10);
+	return s;
+}
+
+bool testlookup()
+{
+	typedef sjtu::map<std::string, int, Less> Map;
+	Map mp;
+	std::map<std::string, int> std_mp;
+	for (int i = 1; i <= 20000; i++) {
+		std::string key = make_key(rand() % 100000);
+		mp[key] = i;
+		std_mp[key] = i;
+	}
+	std::string *probe = new std::string[5000];
+	for (int i = 0; i < 5000; i++) probe[i] = make_key(rand() % 100000);
+
+	long long before = allocations;
+	for (int i = 0; i < 5000; i++) {
+		const char *s = probe[i].c_str();
+		std::map<std::string, int>::iterator std_it = std_mp.find(probe[i]);
+		Map::iterator it = mp.find(s);
+		if ((it == mp.end()) != (std_it == std_mp.end())) return false;
+		if (mp.count(s) != std_mp.count(probe[i])) return false;
+		if (std_it != std_mp.end() && (it->second != std_it->second || mp.at(s) != std_it->second)) return false;
+		std::map<std::string, int>::iterator std_lo = std_mp.lower_bound(probe[i]);
+		Map::const_iterator lo = static_cast<const Map &>(mp).lower_bound(s);
+		if ((lo == mp.cend()) != (std_lo == std_mp.end())) return false;
+		if (lo != mp.cend() && lo->first != std_lo->first) return false;
+		Map::iterator hi = mp.upper_bound(s);
+		std::map<std::string, int>::iterator std_hi = std_mp.upper_bound(probe[i]);
+		if ((hi == mp.end()) != (std_hi == std_mp.end())) return false;
+	}
+	//查找过程中没有构造临时的std::string
+	if (allocations != before) return false;
+	try {
+		mp.at("no-such-key-at-all-in-this-map");
+		return false;
+	} catch (sjtu::index_out_of_bound &) {}
+	delete[] probe;
+
+	//一个Initial和很多个key等价
+	for (char c = 'a'; c <= 'z'; c++) {
+		Initial x = {c};
+		size_t cnt = 0;
+		for (std::map<std::string, int>::iterator it = std_mp.begin(); it != std_mp.end(); ++it)
+			if (it->first[0] == c) cnt++;
+		if (mp.count(x) != cnt) return false;
+		sjtu::pair<Map::iterator, Map::iterator> eq = mp.equal_range(x);
+		size_t walk = 0;
+		for (Map::iterator it = eq.first; it != eq.second; ++it, walk++)
+			if (it->first[0] != c) return false;
+		if (walk != cnt) return false;
+	}
+	Initial r = {'r'}, z = {'z'};
+	return mp.find(r) != mp.end() && mp.at(r) == mp.find(r)->second && mp.find(z) == mp.end() &&
+	       mp.lower_bound(z) == mp.end();
+}
+
+bool testless()
+{
+	//std::less<>也是透明的
+	sjtu::map<std::string, int, std::less<> > mp;
+	for (int i = 0; i < 100; i++) mp[make_key(i)] = i;
+	long long before = allocations;
+	bool ok = mp.count("request-router-path-b1") == 1 && mp.at("request-router-path-z52") == 25 &&
+	          mp.find("request-router-path-q") == mp.end();
+	return ok && allocations == before;
+}
+
+int main()
+{
+	std::cout << (testlookup() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testless() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+long long compares = 0;
+
+//数一下比较了多少次
+struct Less {
+	bool operator()(const int &a, const int &b) const {
+		compares++;
+		return a < b;
+	}
+};
+
+//检查红黑树的性质和子树大小,返回黑高,不满足返回-1
+template<class Node>
+int check(const Node *t, const Node *fa, size_t &cnt, bool ranked) {
+	if (t == nullptr) return 1;
+	size_t before = cnt++;
+	if (t->fa != fa) return -1;
+	if (t->color == 0 && ((t->left && t->left->color == 0) || (t->right && t->right->color == 0))) return -1;
+	int l = check(t->left, t, cnt, ranked), r = check(t->right, t, cnt, ranked);
+	if (l < 0 || l != r) return -1;
+	if (ranked && t->get_size() != cnt - before) return -1;
+	return l + (t->color == 1);
+}
+
+template<class M>
+bool same(M &mp, const std::map<int, int> &std_mp, bool ranked) {
+	size_t cnt = 0;
+	if (mp.mp.root && mp.mp.root->color != 1) return false;
+	if (check(mp.mp.root, (decltype(mp.mp.root)) nullptr, cnt, ranked) < 0 || cnt != std_mp.size()) return false;
+	if (mp.size() != std_mp.size()) return false;
+	typename M::iterator it = mp.begin();
+	for (std::map<int, int>::const_iterator std_it = std_mp.begin(); std_it != std_mp.end(); ++std_it, ++it)
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+	if (it != mp.end()) return false;
+	return mp.empty() || (--mp.end())->first == std_mp.rbegin()->first;
+}
+
+template<class M>
+bool testhint(bool ranked)
+{
+	typedef sjtu::pair<const int, int> Value;
+	M mp;
+	std::map<int, int> std_mp;
+	//递增的key,提示是end()
+	compares = 0;
+	for (int i = 0; i < 100000; i++) {
+		typename M::iterator it = mp.insert(mp.cend(), Value(i * 4, i));
+		if (it->first != i * 4) return false;
+		std_mp[i * 4] = i;
+	}
+	if (compares > 100000 * 3) return false;
+	if (!same(mp, std_mp, ranked)) return false;
+
+	//递减的key,提示是begin()
+	compares = 0;
+	for (int i = -1; i >= -50000; i--) {
+		mp.emplace_hint(mp.cbegin(), i * 4, i);
+		std_mp[i * 4] = i;
+	}
+	if (compares > 50000 * 3) return false;
+	if (!same(mp, std_mp, ranked)) return false;
+
+	//提示是后一个元素,中间插入
+	for (int i = 0; i < 50000; i++) {
+		int key = (rand() % 150000 - 50000) * 4 + 1 + rand() % 3;
+		typename M::iterator next = mp.upper_bound(key);
+		typename M::iterator it = rand() % 2 ? mp.insert(next, Value(key, i)) : mp.emplace_hint(next, key, i);
+		if (it->first != key) return false;
+		std_mp.insert(std::pair<int, int>(key, i));
+	}
+	if (!same(mp, std_mp, ranked)) return false;
+
+	//错误的提示和已经存在的key
+	for (int i = 0; i < 50000; i++) {
+		int key = rand() % 800000 - 200000;
+		typename M::iterator hint = mp.find(rand() % 600000 - 200000);
+		if (hint == mp.end()) hint = mp.begin();
+		typename M::iterator it = rand() % 2 ? mp.insert(hint, Value(key, -i)) : mp.emplace_hint(hint, key, -i);
+		if (it->first != key) return false;
+		std_mp.insert(std::pair<int, int>(key, -i));
+		if (it->second != std_mp[key]) return false;
+	}
+	if (!same(mp, std_mp, ranked)) return false;
+
+	//删掉一部分再用提示插回去
+	for (int i = 0; i < 30000; i++) {
+		typename M::iterator it = mp.find(rand() % 600000 - 200000);
+		if (it == mp.end()) continue;
+		int key = it->first, value = it->second;
+		typename M::iterator next = it;
+		++next;
+		mp.erase(it);
+		if (rand() % 2) mp.insert(next, Value(key, value));
+		else std_mp.erase(key);
+	}
+	if (!same(mp, std_mp, ranked)) return false;
+
+	M other;
+	try {
+		mp.insert(other.cend(), Value(1, 1));
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	//空的map
+	other.emplace_hint(other.cend(), 1, 1);
+	other.insert(other.cbegin(), Value(0, 0));
+	std::map<int, int> two;
+	two[0] = 0;
+	two[1] = 1;
+	return same(other, two, ranked);
+}
+
+int main()
+{
+	typedef sjtu::pair<const int, int> Value;
+	typedef sjtu::slab_allocator<Value> Alloc;
+	std::cout << (testhint<sjtu::map<int, int, Less> >(false) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testhint<sjtu::map<int, int, Less, Alloc, sjtu::order_statistics> >(true) ? "OKAY" : "FAIL")
+	          << std::endl;
+	std::cout << (testhint<sjtu::map<int, int, Less, Alloc, sjtu::threaded_links> >(false) ? "OKAY" : "FAIL")
+	          << std::endl;
+	return 0;
+}
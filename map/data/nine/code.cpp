@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <iterator>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+struct PlainNode {
+	void *left, *right, *fa;
+	int color;
+	sjtu::pair<const int, int> data;
+};
+
+typedef sjtu::ranked_map<int, int> Map;
+
+bool testrank()
+{
+	Map mp;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 200000; i++) {
+		int op = rand() % 3, key = rand() % 30000;
+		if (op < 2) {
+			mp[key] = i;
+			std_mp[key] = i;
+		} else {
+			Map::iterator it = mp.find(key);
+			if (it != mp.end()) mp.erase(it);
+			std_mp.erase(key);
+		}
+		if (i % 97) continue;
+		//rank: 比key小的个数
+		int q = rand() % 30000;
+		if (mp.rank(q) != (size_t) std::distance(std_mp.begin(), std_mp.lower_bound(q))) return false;
+		if (std_mp.empty()) continue;
+		size_t k = rand() % std_mp.size();
+		std::map<int, int>::iterator std_it = std_mp.begin();
+		std::advance(std_it, k);
+		Map::iterator it = mp.select(k);
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+		if (it - mp.begin() != (std::ptrdiff_t) k || mp.end() - it != (std::ptrdiff_t) (std_mp.size() - k)) return false;
+	}
+	//每个位置都检查一遍
+	size_t k = 0;
+	const Map &cmp = mp;
+	for (Map::iterator it = mp.begin(); it != mp.end(); ++it, ++k) {
+		if (mp.rank(it->first) != k || mp.select(k) != it) return false;
+		if (cmp.select(k) - cmp.cbegin() != (std::ptrdiff_t) k) return false;
+	}
+	try {
+		mp.select(mp.size());
+		return false;
+	} catch (sjtu::index_out_of_bound) {}
+	Map other;
+	try {
+		std::ptrdiff_t d = other.end() - mp.begin();
+		return d < 0 && false;
+	} catch (sjtu::invalid_iterator) {}
+
+	//复制会带上子树大小
+	Map copy(mp);
+	for (size_t i = 0; i < copy.size(); i += 101) {
+		if (copy.select(i)->first != mp.select(i)->first) return false;
+	}
+	return k == std_mp.size();
+}
+
+int main()
+{
+	//不开启时节点大小不变
+	std::cout << (sizeof(sjtu::map<int, int>::NODE) == sizeof(PlainNode) &&
+	              sizeof(Map::NODE) > sizeof(PlainNode) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testrank() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
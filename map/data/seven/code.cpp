@@ -0,0 +1,99 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//记录申请和释放次数的分配器
+long long live_blocks = 0;
+
+template<class T>
+struct CountingAllocator {
+	typedef T value_type;
+	CountingAllocator() {}
+	template<class U>
+	CountingAllocator(const CountingAllocator<U> &) {}
+	T *allocate(size_t n) {
+		live_blocks++;
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T *p, size_t n) {
+		live_blocks--;
+		std::allocator<T>().deallocate(p, n);
+	}
+	bool operator==(const CountingAllocator &) const { return true; }
+	bool operator!=(const CountingAllocator &) const { return false; }
+};
+
+//统计构造和析构的次数,检查整块释放时值仍然被析构
+struct Counted {
+	static long long alive;
+	std::string s;
+	Counted(const std::string &_s) : s(_s) { alive++; }
+	Counted(const Counted &other) : s(other.s) { alive++; }
+	~Counted() { alive--; }
+};
+
+long long Counted::alive = 0;
+
+template<class Map>
+bool testmap()
+{
+	Map mp;
+	std::map<int, std::string> std_mp;
+	for (int round = 0; round < 3; round++) {
+		for (int i = 0; i < 100000; i++) {
+			int key = rand() % 20000;
+			if (rand() % 3) {
+				std::string v = std::to_string(rand());
+				mp.insert(typename Map::value_type(key, Counted(v)));
+				std_mp.insert(std::make_pair(key, v));
+			} else {
+				typename Map::iterator it = mp.find(key);
+				if (it != mp.end()) mp.erase(it);
+				std_mp.erase(key);
+			}
+		}
+		if (mp.size() != std_mp.size()) return false;
+		{
+			Map copy(mp);
+			std::map<int, std::string>::iterator std_it = std_mp.begin();
+			for (typename Map::iterator it = copy.begin(); it != copy.end(); ++it, ++std_it) {
+				if (it->first != std_it->first || it->second.s != std_it->second) return false;
+			}
+		}
+		if (Counted::alive != (long long) std_mp.size()) return false;
+		if (round < 2) {
+			mp.clear();
+			std_mp.clear();
+			if (Counted::alive != 0 || mp.begin() != mp.end()) return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	bool ok = testmap<sjtu::map<int, Counted> >() && Counted::alive == 0;
+	std::cout << (ok ? "OKAY" : "FAIL") << std::endl;
+	ok = testmap<sjtu::map<int, Counted, std::less<int>, CountingAllocator<int> > >();
+	std::cout << (ok && Counted::alive == 0 && live_blocks == 0 ? "OKAY" : "FAIL") << std::endl;
+	ok = testmap<sjtu::map<int, Counted, std::less<int>, std::allocator<int> > >();
+	std::cout << (ok && Counted::alive == 0 ? "OKAY" : "FAIL") << std::endl;
+
+	//不需要析构的值,清空时整块释放
+	sjtu::map<int, int> big;
+	for (int i = 0; i < 1000000; i++) big.insert(sjtu::pair<int, int>(rand(), i));
+	big.clear();
+	for (int i = 0; i < 1000; i++) big[i] = i;
+	std::cout << (big.size() == 1000 && big.at(999) == 999 ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include "concurrent_map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//数一下还活着多少个,第throw_at次复制时抛异常
+std::atomic<long long> alive(0), copies(0);
+long long throw_at = -1;
+
+struct Value {
+	int v;
+	Value(int _v = 0) : v(_v) {
+		alive++;
+	}
+	Value(const Value &other) : v(other.v) {
+		if (++copies == throw_at) throw 1;
+		alive++;
+	}
+	Value &operator=(const Value &other) {
+		v = other.v;
+		return *this;
+	}
+	~Value() {
+		alive--;
+	}
+};
+
+typedef sjtu::concurrent_map<int, Value> Map;
+typedef sjtu::pair<const int, Value> Pair;
+
+template<class Snap>
+bool same(const Snap &snap, const std::map<int, int> &std_map)
+{
+	if (snap.size() != std_map.size()) return false;
+	auto it = std_map.begin();
+	for (auto jt = snap.begin(); jt != snap.end(); ++jt, ++it) {
+		if (it == std_map.end() || jt->first != it->first || jt->second.v != it->second) return false;
+	}
+	return it == std_map.end();
+}
+
+bool testsingle()
+{
+	Map mp;
+	std::map<int, int> std_map;
+	for (int i = 0; i < 50000; i++) {
+		int op = rand() % 4, key = rand() % 5000, val = rand();
+		if (op == 0) {
+			if (mp.insert(Pair(key, Value(val))) != std_map.insert(std::make_pair(key, val)).second) return false;
+		} else if (op == 1) {
+			bool fresh = !std_map.count(key);
+			std_map[key] = val;
+			if (mp.assign(key, Value(val)) != fresh) return false;
+		} else if (op == 2) {
+			if (mp.erase(key) != std_map.erase(key)) return false;
+		} else {
+			Value v;
+			bool found = mp.get(key, v);
+			if (found != (bool) std_map.count(key) || mp.count(key) != std_map.count(key)) return false;
+			if (found && v.v != std_map[key]) return false;
+		}
+		if (mp.size() != std_map.size()) return false;
+	}
+	if (!same(mp.take_snapshot(), std_map)) return false;
+
+	//快照不受之后写操作的影响
+	Map::snapshot snap = mp.take_snapshot();
+	std::map<int, int> old = std_map;
+	for (int i = 0; i < 3000; i++) {
+		int key = rand() % 5000;
+		if (rand() % 2) mp.assign(key, Value(i));
+		else mp.erase(key);
+	}
+	if (!same(snap, old)) return false;
+	for (auto it = old.begin(); it != old.end(); ++it)
+		if (snap.at(it->first).v != it->second || snap.find(it->first)->second.v != it->second) return false;
+	try {
+		snap.at(-1);
+		return false;
+	} catch (sjtu::index_out_of_bound) {}
+	try {
+		mp.at(-1);
+		return false;
+	} catch (sjtu::index_out_of_bound) {}
+	mp.clear();
+	return mp.empty() && mp.take_snapshot().begin() == mp.take_snapshot().end() && snap.size() == old.size();
+}
+
+//复制时抛异常,map不变,也不漏掉节点
+bool testthrow()
+{
+	{
+		Map mp;
+		std::map<int, int> std_map;
+		for (int i = 0; i < 2000; i++) {
+			int key = rand() % 1000, val = rand();
+			throw_at = copies + 1 + rand() % 8;
+			try {
+				int op = rand() % 3;
+				if (op == 0) {
+					if (mp.insert(Pair(key, Value(val)))) std_map.insert(std::make_pair(key, val));
+				} else if (op == 1) {
+					mp.assign(key, Value(val));
+					std_map[key] = val;
+				} else {
+					if (mp.erase(key)) std_map.erase(key);
+				}
+			} catch (int) {}
+			throw_at = -1;
+			if (!same(mp.take_snapshot(), std_map)) return false;
+		}
+	}
+	return alive == 0;
+}
+
+//读者一直在查,写者保证每个值都是key的3倍
+bool testthreads()
+{
+	{
+		Map mp;
+		const int K = 20000;
+		for (int i = 0; i < K; i += 2) mp.insert(Pair(i, Value(i * 3)));
+		std::atomic<bool> stop(false), ok(true);
+		std::vector<std::thread> readers;
+		for (int r = 0; r < 4; r++) {
+			readers.push_back(std::thread([&mp, &stop, &ok, r]() {
+				unsigned seed = 12345 + r;
+				while (!stop.load()) {
+					seed = seed * 1103515245u + 12345u;
+					int key = (int) (seed >> 1) % K;
+					Value v;
+					if (mp.get(key, v) && v.v != key * 3) ok = false;
+					if ((seed >> 5) % 64 == 0) {
+						Map::snapshot snap = mp.take_snapshot();
+						size_t n = 0;
+						int last = -1;
+						for (auto it = snap.begin(); it != snap.end(); ++it, n++) {
+							if (it->first <= last || it->second.v != it->first * 3) ok = false;
+							last = it->first;
+						}
+						if (n != snap.size()) ok = false;
+					}
+				}
+			}));
+		}
+		for (int i = 0; i < 200000; i++) {
+			int key = rand() % K;
+			if (rand() % 2) mp.assign(key, Value(key * 3));
+			else mp.erase(key);
+		}
+		stop = true;
+		for (size_t i = 0; i < readers.size(); i++) readers[i].join();
+		if (!ok) return false;
+		//没有读者时,被替换的节点最多攒到回收的阈值
+		for (int i = 0; i < 1000; i++) mp.assign(rand() % K, Value(0));
+		if (alive > (long long) mp.size() + 1000) return false;
+	}
+	return alive == 0;
+}
+
+int main()
+{
+	std::cout << (testsingle() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthrow() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthreads() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
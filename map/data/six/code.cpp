@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//插入的返回值、begin和--end与std::map一致
+bool testinsert()
+{
+	sjtu::map<int, int> mp;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 200000; i++) {
+		int op = rand() % 4, key = rand() % 5000;
+		if (op) {
+			sjtu::pair<sjtu::map<int, int>::iterator, bool> res = mp.insert(sjtu::pair<int, int>(key, i));
+			std::pair<std::map<int, int>::iterator, bool> std_res = std_mp.insert(std::make_pair(key, i));
+			if (res.second != std_res.second) return false;
+			if (res.first->first != key || res.first->second != std_res.first->second) return false;
+		} else {
+			sjtu::map<int, int>::iterator it = mp.find(key);
+			if ((it == mp.end()) != (std_mp.find(key) == std_mp.end())) return false;
+			if (it != mp.end()) {
+				mp.erase(it);
+				std_mp.erase(key);
+			}
+		}
+		if (mp.size() != std_mp.size()) return false;
+		if (std_mp.empty()) {
+			if (mp.begin() != mp.end()) return false;
+			continue;
+		}
+		sjtu::map<int, int>::iterator last = mp.end();
+		--last;
+		if (mp.begin()->first != std_mp.begin()->first || last->first != std_mp.rbegin()->first) return false;
+	}
+	std::map<int, int>::iterator std_it = std_mp.begin();
+	for (sjtu::map<int, int>::iterator it = mp.begin(); it != mp.end(); ++it, ++std_it) {
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+	}
+	return std_it == std_mp.end();
+}
+
+int main()
+{
+	std::cout << (testinsert() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
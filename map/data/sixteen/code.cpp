@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+
+#include "map.hpp"
+#include "class-bint.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+long long compares = 0;
+
+//数一下比较了多少次
+template<class T>
+struct Less {
+	bool operator()(const T &a, const T &b) const {
+		compares++;
+		return a < b;
+	}
+};
+
+template<class Node>
+int height(const Node *t) {
+	if (t == nullptr) return 0;
+	int l = height(t->left), r = height(t->right);
+	return (l > r ? l : r) + 1;
+}
+
+//查找、插入、删除每一层只比较一次key,最后再判断一次相等
+bool testcount()
+{
+	typedef sjtu::map<int, int, Less<int> > Map;
+	Map mp;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 100000; i++) {
+		int key = rand() % 200000;
+		mp[key] = i;
+		std_mp[key] = i;
+	}
+	//插入时旋转会让路上的节点再比较一次,只看平均
+	long long insert_compares = 0, erase_compares = 0, erased = 0;
+	for (int i = 0; i < 100000; i++) {
+		int key = rand() % 200000;
+		bool found = std_mp.count(key) == 1;
+		long long before = compares;
+		bool inserted = mp.insert(sjtu::pair<const int, int>(key, -i)).second;
+		insert_compares += compares - before;
+		if (inserted == found) return false;
+		std_mp.insert(std::pair<int, int>(key, -i));
+	}
+	int h = height(mp.mp.root);
+	for (int i = 0; i < 100000; i++) {
+		int key = rand() % 200000;
+		long long before = compares;
+		bool found = mp.find(key) != mp.end();
+		if (compares - before > h + 1 || found != (std_mp.count(key) == 1)) return false;
+		before = compares;
+		if (mp.count(key) != found || compares - before > h + 1) return false;
+	}
+	if (insert_compares > 100000ll * h) return false;
+	for (int i = 0; i < 50000; i++) {
+		Map::iterator it = mp.find(rand() % 200000);
+		if (it == mp.end()) continue;
+		int key = it->first;
+		long long before = compares;
+		mp.erase(it);
+		erase_compares += compares - before;
+		erased++;
+		std_mp.erase(key);
+	}
+	if (erase_compares > erased * h) return false;
+	std::map<int, int>::iterator std_it = std_mp.begin();
+	for (Map::iterator it = mp.begin(); it != mp.end(); ++it, ++std_it)
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+	return std_it == std_mp.end() && mp.size() == std_mp.size();
+}
+
+//比较很慢的key
+bool testbint()
+{
+	typedef sjtu::map<Util::Bint, int, Less<Util::Bint> > Map;
+	Map mp;
+	std::map<Util::Bint, int> std_mp;
+	for (int i = 0; i < 3000; i++) {
+		Util::Bint key = Util::Bint(rand() % 1000) * Util::Bint(rand()) * Util::Bint(rand());
+		mp[key] = i;
+		std_mp[key] = i;
+		if (rand() % 4 == 0) {
+			Map::iterator it = mp.find(key);
+			mp.erase(it);
+			std_mp.erase(key);
+		}
+	}
+	std::map<Util::Bint, int>::iterator std_it = std_mp.begin();
+	for (Map::iterator it = mp.begin(); it != mp.end(); ++it, ++std_it)
+		if (!(it->first == std_it->first) || it->second != std_it->second) return false;
+	return std_it == std_mp.end();
+}
+
+int main()
+{
+	std::cout << (testcount() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testbint() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <utility>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+struct Greater {
+	bool operator()(const int &a, const int &b) const {
+		return a > b;
+	}
+};
+
+template<class Map, class StdMap>
+bool testbound()
+{
+	Map mp;
+	StdMap std_mp;
+	for (int i = 0; i < 100000; i++) {
+		int key = rand() % 50000;
+		if (rand() % 4) {
+			mp[key] = i;
+			std_mp[key] = i;
+		} else {
+			typename Map::iterator it = mp.find(key);
+			if (it != mp.end()) mp.erase(it);
+			std_mp.erase(key);
+		}
+		if (i % 13) continue;
+		int q = rand() % 50002 - 1;
+		typename Map::iterator lo = mp.lower_bound(q), hi = mp.upper_bound(q);
+		typename StdMap::iterator std_lo = std_mp.lower_bound(q), std_hi = std_mp.upper_bound(q);
+		if ((lo == mp.end()) != (std_lo == std_mp.end()) || (hi == mp.end()) != (std_hi == std_mp.end())) return false;
+		if (lo != mp.end() && lo->first != std_lo->first) return false;
+		if (hi != mp.end() && hi->first != std_hi->first) return false;
+		sjtu::pair<typename Map::iterator, typename Map::iterator> eq = mp.equal_range(q);
+		if (eq.first != lo || eq.second != hi) return false;
+
+		//[a, b) 中的元素
+		int a = rand() % 50000, b = a + (int) (rand() % 200) - 20;
+		typename StdMap::iterator std_it = std_mp.lower_bound(a), std_end = std_mp.lower_bound(b);
+		if (std_mp.key_comp()(b, a)) std_end = std_it;
+		int cnt = 0;
+		for (auto &v : mp.range(a, b)) {
+			if (std_it == std_end || v.first != std_it->first || v.second != std_it->second) return false;
+			++std_it;
+			cnt++;
+		}
+		if (std_it != std_end || mp.range(a, b).empty() != (cnt == 0)) return false;
+	}
+
+	//const版本
+	//lowest/highest在比较器的顺序下比所有key都小/大
+	int lowest = -1, highest = 1000000;
+	if (std_mp.key_comp()(highest, lowest)) std::swap(lowest, highest);
+	const Map &cmp = mp;
+	typename StdMap::iterator std_it = std_mp.begin();
+	for (typename Map::const_iterator it = cmp.lower_bound(lowest); it != cmp.cend(); ++it, ++std_it) {
+		if (it->first != std_it->first) return false;
+	}
+	typename Map::const_range_type all = cmp.range(lowest, highest);
+	return std_it == std_mp.end() && cmp.upper_bound(highest) == cmp.cend() && all.begin() == cmp.cbegin() &&
+	       all.end() == cmp.cend();
+}
+
+int main()
+{
+	std::cout << (testbound<sjtu::map<int, int>, std::map<int, int> >() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testbound<sjtu::map<int, int, Greater>, std::map<int, int, Greater> >() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+typedef sjtu::threaded_map<int, int> TMap;
+typedef sjtu::map<int, int, std::less<int>, sjtu::slab_allocator<sjtu::pair<const int, int> >,
+		sjtu::augment<sjtu::order_statistics, sjtu::threaded_links> > RTMap;
+
+//正着和倒着各走一遍,都要和std::map一致
+template<class M>
+bool same(M &mp, const std::map<int, int> &std_mp) {
+	if (mp.size() != std_mp.size()) return false;
+	typename M::iterator it = mp.begin();
+	for (std::map<int, int>::const_iterator std_it = std_mp.begin(); std_it != std_mp.end(); ++std_it, it++)
+		if (it == mp.end() || it->first != std_it->first || it->second != std_it->second) return false;
+	if (it != mp.end()) return false;
+	typename M::const_iterator cit = mp.cend();
+	for (std::map<int, int>::const_reverse_iterator std_it = std_mp.rbegin(); std_it != std_mp.rend(); ++std_it) {
+		--cit;
+		if (cit->first != std_it->first) return false;
+	}
+	if (cit != mp.cbegin()) return false;
+	try {
+		--cit;
+		return false;
+	} catch (sjtu::invalid_iterator &) {}
+	return true;
+}
+
+template<class M>
+bool testthread()
+{
+	M mp;
+	std::map<int, int> std_mp;
+	for (int i = 0; i < 200000; i++) {
+		int key = rand() % 20000;
+		if (rand() % 3) {
+			mp[key] = i;
+			std_mp[key] = i;
+		} else {
+			typename M::iterator it = mp.find(key);
+			if (it != mp.end()) mp.erase(it);
+			std_mp.erase(key);
+		}
+		if (i % 20011 == 0 && !same(mp, std_mp)) return false;
+	}
+	if (!same(mp, std_mp)) return false;
+
+	//删空再插入
+	while (mp.size()) mp.erase(mp.begin());
+	std_mp.clear();
+	if (!same(mp, std_mp)) return false;
+	mp[5] = 5;
+	std_mp[5] = 5;
+	if (!same(mp, std_mp)) return false;
+
+	//复制、赋值、清空
+	for (int i = 0; i < 1000; i++) {
+		mp[rand() % 5000] = i;
+	}
+	std_mp.clear();
+	for (typename M::iterator it = mp.begin(); it != mp.end(); ++it) std_mp[it->first] = it->second;
+	M copy(mp), assigned;
+	assigned[1] = 1;
+	assigned = mp;
+	if (!same(copy, std_mp) || !same(assigned, std_mp)) return false;
+	M moved(std::move(copy));
+	if (!same(moved, std_mp) || copy.begin() != copy.end()) return false;
+	copy[3] = 3;
+	assigned.clear();
+	assigned[4] = 4;
+	std::map<int, int> one;
+	one[3] = 3;
+	if (!same(copy, one)) return false;
+
+	//有序建树
+	std::vector<sjtu::pair<const int, int> > v;
+	for (int i = 0; i < 3000; i++) v.push_back(sjtu::pair<const int, int>(i * 2, i));
+	M sorted = M::from_sorted(v.begin(), v.end());
+	std::map<int, int> std_sorted;
+	for (int i = 0; i < 3000; i++) std_sorted[i * 2] = i;
+	if (!same(sorted, std_sorted)) return false;
+
+	//集合运算
+	M u(sorted), x(sorted), d(sorted);
+	std::map<int, int> su(std_sorted), sx, sd;
+	for (std::map<int, int>::iterator it = std_mp.begin(); it != std_mp.end(); ++it) su.insert(*it);
+	for (std::map<int, int>::iterator it = std_sorted.begin(); it != std_sorted.end(); ++it) {
+		if (std_mp.count(it->first)) sx.insert(*it);
+		else sd.insert(*it);
+	}
+	u.union_with(mp);
+	x.intersect_with(mp);
+	d.difference_with(mp);
+	return same(u, su) && same(x, sx) && same(d, sd);
+}
+
+struct PlainNode {
+	void *left, *right, *fa;
+	int color;
+	sjtu::pair<const int, int> data;
+};
+
+int main()
+{
+	std::cout << (testthread<TMap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthread<RTMap>() ? "OKAY" : "FAIL") << std::endl;
+	//线索只在打开时占空间
+	bool size_ok = sizeof(sjtu::map<int, int>::NODE) == sizeof(PlainNode) &&
+	               sizeof(TMap::NODE) == sizeof(PlainNode) + 2 * sizeof(void *);
+	std::cout << (size_ok ? "OKAY" : "FAIL") << std::endl;
+	RTMap r;
+	for (int i = 0; i < 100; i++) r[i * 3] = i;
+	std::cout << (r.rank(31) == 11 && r.select(20)->first == 60 && r.end() - r.begin() == 100 ? "OKAY" : "FAIL")
+	          << std::endl;
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+
+#include "map.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//检查红黑树的性质和子树大小,返回黑高,不满足返回-1
+template<class Node>
+int check(const Node *t, const Node *fa, size_t &cnt, bool ranked) {
+	if (t == nullptr) return 1;
+	size_t before = cnt++;
+	if (t->fa != fa) return -1;
+	if (t->color == 0 && ((t->left && t->left->color == 0) || (t->right && t->right->color == 0))) return -1;
+	int l = check(t->left, t, cnt, ranked), r = check(t->right, t, cnt, ranked);
+	if (l < 0 || l != r) return -1;
+	if (ranked && t->get_size() != cnt - before) return -1;
+	return l + (t->color == 1);
+}
+
+template<class M>
+bool same(const M &mp, const std::map<int, int> &std_mp, bool ranked) {
+	size_t cnt = 0;
+	if (mp.mp.root && mp.mp.root->color != 1) return false;
+	if (check(mp.mp.root, (decltype(mp.mp.root)) nullptr, cnt, ranked) < 0) return false;
+	if (cnt != mp.size() || mp.size() != std_mp.size()) return false;
+	typename M::const_iterator it = mp.cbegin();
+	for (std::map<int, int>::const_iterator std_it = std_mp.begin(); std_it != std_mp.end(); ++std_it, ++it)
+		if (it->first != std_it->first || it->second != std_it->second) return false;
+	if (it != mp.cend()) return false;
+	return mp.empty() || (--mp.cend())->first == std_mp.rbegin()->first;
+}
+
+template<class M>
+void fill(M &mp, std::map<int, int> &std_mp, int n, int range, int tag) {
+	for (int i = 0; i < n; i++) {
+		int key = rand() % range;
+		mp[key] = i * 4 + tag;
+		std_mp[key] = i * 4 + tag;
+	}
+}
+
+template<class M>
+bool testops(int n, int m, int range, bool ranked)
+{
+	M a, b;
+	std::map<int, int> sa, sb;
+	fill(a, sa, n, range, 0);
+	fill(b, sb, m, range, 1);
+
+	M u(a), x(a), d(a);
+	std::map<int, int> su(sa), sx, sd;
+	for (std::map<int, int>::iterator it = sb.begin(); it != sb.end(); ++it) su.insert(*it);
+	for (std::map<int, int>::iterator it = sa.begin(); it != sa.end(); ++it) {
+		if (sb.count(it->first)) sx.insert(*it);
+		else sd.insert(*it);
+	}
+
+	//留在原来map中的元素,迭代器不失效
+	typename M::iterator keep = u.begin();
+	int keep_key = keep == u.end() ? 0 : keep->first;
+	u.union_with(b);
+	x.intersect_with(b);
+	d.difference_with(b);
+	if (!same(u, su, ranked) || !same(x, sx, ranked) || !same(d, sd, ranked) || !same(b, sb, ranked)) return false;
+	if (keep != u.end() && keep->first != keep_key) return false;
+
+	//和自己做运算
+	u.union_with(u);
+	x.intersect_with(x);
+	d.difference_with(d);
+	if (!same(u, su, ranked) || !same(x, sx, ranked) || !d.empty()) return false;
+
+	//运算之后还能正常插入删除
+	for (int i = 0; i < 1000; i++) {
+		int key = rand() % range;
+		if (rand() % 2) {
+			x[key] = i;
+			sx[key] = i;
+		} else {
+			typename M::iterator it = x.find(key);
+			if (it != x.end()) x.erase(it);
+			sx.erase(key);
+		}
+	}
+	return same(x, sx, ranked);
+}
+
+int main()
+{
+	typedef sjtu::map<int, int> Map;
+	typedef sjtu::ranked_map<int, int> RMap;
+	bool ok = true;
+	int sizes[][3] = {{0, 0, 10}, {0, 50, 100}, {50, 0, 100}, {1, 1, 2}, {100, 100, 150}, {1000, 10, 5000},
+	                  {10, 1000, 5000}, {3000, 3000, 4000}};
+	for (int i = 0; i < 8; i++) ok = ok && testops<Map>(sizes[i][0], sizes[i][1], sizes[i][2], false);
+	std::cout << (ok ? "OKAY" : "FAIL") << std::endl;
+	ok = true;
+	for (int i = 0; i < 8; i++) ok = ok && testops<RMap>(sizes[i][0], sizes[i][1], sizes[i][2], true);
+	std::cout << (ok ? "OKAY" : "FAIL") << std::endl;
+	//足够大时会分到多个线程
+	std::cout << (testops<Map>(400000, 300000, 1000000, false) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testops<RMap>(300000, 5000, 600000, true) ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,681 @@
+/**
+ * implement a container like std::map with a B+ tree
+ */
+#ifndef SJTU_BTREE_MAP_HPP
+#define SJTU_BTREE_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * a sorted map with the interface of sjtu::map, implemented by a B+ tree.
+ * every node holds many keys in one contiguous block of about 512 bytes, so a
+ * lookup touches about log_64(n) nodes instead of log_2(n); all values live in
+ * the leaves, which are chained in key order for the iterators.
+ * keys and values are kept in raw storage and need no default constructor.
+ * unlike sjtu::map, insert and erase move elements between and inside nodes,
+ * so they invalidate every iterator.
+ */
+    template<
+            class Key,
+            class T,
+            class Compare = std::less<Key>
+    >
+    class btree_map {
+    public:
+        typedef pair<const Key, T> value_type;
+
+    private:
+        //每个节点大约512字节,至少放8个
+        enum {
+            LEAF_CAP = 512 / sizeof(value_type) > 8 ? 512 / sizeof(value_type) : 8,
+            INNER_CAP = 512 / (sizeof(Key) + sizeof(void *)) > 8 ? 512 / (sizeof(Key) + sizeof(void *)) : 8,
+            LEAF_MIN = LEAF_CAP / 2,
+            INNER_MIN = (INNER_CAP - 1) / 2
+        };
+
+        //叶子的cnt是元素个数,内部节点的cnt是关键字个数,儿子比关键字多一个
+        struct Node {
+            bool is_leaf;
+            int cnt;
+        };
+
+        struct Leaf : Node {
+            Leaf *prev, *next;
+            alignas(value_type) unsigned char buf[LEAF_CAP * sizeof(value_type)];
+
+            value_type *val() {
+                return reinterpret_cast<value_type *>(buf);
+            }
+        };
+
+        //child[i]中的关键字都小于key[i],child[i+1]中的都不小于key[i]
+        struct Inner : Node {
+            Node *child[INNER_CAP + 1];
+            alignas(Key) unsigned char buf[INNER_CAP * sizeof(Key)];
+
+            Key *key() {
+                return reinterpret_cast<Key *>(buf);
+            }
+        };
+
+        Node *root;
+        Leaf *head, *rear; //最左和最右的叶子
+        size_t len;
+
+    public:
+        class const_iterator;
+
+        class iterator {
+            friend class btree_map;
+
+        private:
+            Leaf *leaf; //为空时表示end
+            int pos;
+            const btree_map *id;
+
+        public:
+            iterator() : leaf(nullptr), pos(0), id(nullptr) {}
+
+            iterator(Leaf *_leaf, int _pos, const btree_map *_id) : leaf(_leaf), pos(_pos), id(_id) {}
+
+            iterator operator++(int) {
+                iterator t(*this);
+                ++(*this);
+                return t;
+            }
+
+            iterator &operator++() {
+                if (id == nullptr || leaf == nullptr) throw invalid_iterator();
+                if (++pos == leaf->cnt) {
+                    leaf = leaf->next;
+                    pos = 0;
+                }
+                return *this;
+            }
+
+            iterator operator--(int) {
+                iterator t(*this);
+                --(*this);
+                return t;
+            }
+
+            iterator &operator--() {
+                if (id == nullptr || id->len == 0) throw invalid_iterator();
+                if (leaf == nullptr) {
+                    leaf = id->rear;
+                    pos = leaf->cnt - 1;
+                } else if (pos) {
+                    pos--;
+                } else {
+                    if (leaf->prev == nullptr) throw invalid_iterator();
+                    leaf = leaf->prev;
+                    pos = leaf->cnt - 1;
+                }
+                return *this;
+            }
+
+            value_type &operator*() const {
+                if (leaf == nullptr) throw invalid_iterator();
+                return leaf->val()[pos];
+            }
+
+            value_type *operator->() const {
+                if (leaf == nullptr) throw invalid_iterator();
+                return leaf->val() + pos;
+            }
+
+            bool operator==(const iterator &rhs) const {
+                return id == rhs.id && leaf == rhs.leaf && pos == rhs.pos;
+            }
+
+            bool operator==(const const_iterator &rhs) const {
+                return id == rhs.id && leaf == rhs.leaf && pos == rhs.pos;
+            }
+
+            bool operator!=(const iterator &rhs) const {
+                return !(*this == rhs);
+            }
+
+            bool operator!=(const const_iterator &rhs) const {
+                return !(*this == rhs);
+            }
+        };
+
+        class const_iterator {
+            friend class btree_map;
+
+        private:
+            Leaf *leaf;
+            int pos;
+            const btree_map *id;
+
+        public:
+            const_iterator() : leaf(nullptr), pos(0), id(nullptr) {}
+
+            const_iterator(const iterator &other) : leaf(other.leaf), pos(other.pos), id(other.id) {}
+
+            const_iterator(Leaf *_leaf, int _pos, const btree_map *_id) : leaf(_leaf), pos(_pos), id(_id) {}
+
+            const_iterator operator++(int) {
+                const_iterator t(*this);
+                ++(*this);
+                return t;
+            }
+
+            const_iterator &operator++() {
+                if (id == nullptr || leaf == nullptr) throw invalid_iterator();
+                if (++pos == leaf->cnt) {
+                    leaf = leaf->next;
+                    pos = 0;
+                }
+                return *this;
+            }
+
+            const_iterator operator--(int) {
+                const_iterator t(*this);
+                --(*this);
+                return t;
+            }
+
+            const_iterator &operator--() {
+                if (id == nullptr || id->len == 0) throw invalid_iterator();
+                if (leaf == nullptr) {
+                    leaf = id->rear;
+                    pos = leaf->cnt - 1;
+                } else if (pos) {
+                    pos--;
+                } else {
+                    if (leaf->prev == nullptr) throw invalid_iterator();
+                    leaf = leaf->prev;
+                    pos = leaf->cnt - 1;
+                }
+                return *this;
+            }
+
+            const value_type &operator*() const {
+                if (leaf == nullptr) throw invalid_iterator();
+                return leaf->val()[pos];
+            }
+
+            const value_type *operator->() const {
+                if (leaf == nullptr) throw invalid_iterator();
+                return leaf->val() + pos;
+            }
+
+            bool operator==(const iterator &rhs) const {
+                return id == rhs.id && leaf == rhs.leaf && pos == rhs.pos;
+            }
+
+            bool operator==(const const_iterator &rhs) const {
+                return id == rhs.id && leaf == rhs.leaf && pos == rhs.pos;
+            }
+
+            bool operator!=(const iterator &rhs) const {
+                return !(*this == rhs);
+            }
+
+            bool operator!=(const const_iterator &rhs) const {
+                return !(*this == rhs);
+            }
+        };
+
+        //-------------------------------------------------------------------
+
+        btree_map() : root(nullptr), head(nullptr), rear(nullptr), len(0) {}
+
+        btree_map(const btree_map &other) : root(nullptr), head(nullptr), rear(nullptr), len(0) {
+            copy_from(other);
+        }
+
+        btree_map &operator=(const btree_map &other) {
+            if (this == &other) return *this;
+            clear();
+            copy_from(other);
+            return *this;
+        }
+
+        ~btree_map() {
+            clear();
+        }
+
+        /**
+         * access specified element with bounds checking.
+         * throw index_out_of_bound if such key does not exist.
+         */
+        T &at(const Key &key) {
+            int pos;
+            Leaf *l = find_leaf(key, pos);
+            if (l == nullptr) throw index_out_of_bound();
+            return l->val()[pos].second;
+        }
+
+        const T &at(const Key &key) const {
+            int pos;
+            Leaf *l = find_leaf(key, pos);
+            if (l == nullptr) throw index_out_of_bound();
+            return l->val()[pos].second;
+        }
+
+        /**
+         * access specified element, performing an insertion if such key does not already exist.
+         */
+        T &operator[](const Key &key) {
+            int pos;
+            Leaf *l = find_leaf(key, pos);
+            if (l) return l->val()[pos].second;
+            return insert(value_type(key, T())).first->second;
+        }
+
+        /**
+         * behave like at() throw index_out_of_bound if such key does not exist.
+         */
+        const T &operator[](const Key &key) const {
+            return at(key);
+        }
+
+        iterator begin() {
+            if (len == 0) return end();
+            return iterator(head, 0, this);
+        }
+
+        const_iterator cbegin() const {
+            if (len == 0) return cend();
+            return const_iterator(head, 0, this);
+        }
+
+        iterator end() {
+            return iterator(nullptr, 0, this);
+        }
+
+        const_iterator cend() const {
+            return const_iterator(nullptr, 0, this);
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        size_t size() const {
+            return len;
+        }
+
+        void clear() {
+            if (root) destroy(root);
+            root = nullptr;
+            head = rear = nullptr;
+            len = 0;
+        }
+
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         */
+        pair<iterator, bool> insert(const value_type &value) {
+            if (root == nullptr) root = head = rear = new_leaf();
+            //自上向下,满的节点先分裂,插入时就不需要再往上调整
+            if (full(root)) {
+                Inner *r = new_inner();
+                r->child[0] = root;
+                try {
+                    split_child(r, 0);
+                } catch (...) {
+                    delete r;
+                    throw;
+                }
+                root = r;
+            }
+            Node *t = root;
+            while (!t->is_leaf) {
+                Inner *in = static_cast<Inner *>(t);
+                int i = child_index(in, value.first);
+                if (full(in->child[i])) {
+                    split_child(in, i);
+                    if (!Compare()(value.first, in->key()[i])) i++;
+                }
+                t = in->child[i];
+            }
+
+            Leaf *l = static_cast<Leaf *>(t);
+            int pos = lower_index(l, value.first);
+            if (pos < l->cnt && !Compare()(value.first, l->val()[pos].first))
+                return pair<iterator, bool>(iterator(l, pos, this), false);
+            for (int i = l->cnt; i > pos; i--) relocate(l->val() + i, l->val() + i - 1);
+            try {
+                new(l->val() + pos) value_type(value);
+            } catch (...) {
+                for (int i = pos; i < l->cnt; i++) relocate(l->val() + i, l->val() + i + 1);
+                throw;
+            }
+            l->cnt++;
+            len++;
+            return pair<iterator, bool>(iterator(l, pos, this), true);
+        }
+
+        /**
+         * erase the element at pos.
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         */
+        void erase(iterator pos) {
+            if (pos.id != this || pos.leaf == nullptr) throw invalid_iterator();
+            Key key(pos.leaf->val()[pos.pos].first);
+            erase_from(root, key);
+            len--;
+            if (root->cnt == 0) {
+                //根只剩一个儿子就让儿子当根,叶子空了整棵树就空了
+                Node *t = root;
+                root = root->is_leaf ? nullptr : static_cast<Inner *>(t)->child[0];
+                if (t->is_leaf) head = rear = nullptr;
+                free_node(t);
+            }
+        }
+
+        size_t count(const Key &key) const {
+            int pos;
+            return find_leaf(key, pos) ? 1 : 0;
+        }
+
+        iterator find(const Key &key) {
+            int pos;
+            Leaf *l = find_leaf(key, pos);
+            if (l == nullptr) return end();
+            return iterator(l, pos, this);
+        }
+
+        const_iterator find(const Key &key) const {
+            int pos;
+            Leaf *l = find_leaf(key, pos);
+            if (l == nullptr) return cend();
+            return const_iterator(l, pos, this);
+        }
+
+    private:
+        //把src移动到未构造的dst上,再析构src
+        template<class V>
+        static void relocate(V *dst, V *src) {
+            new(dst) V(std::move(*src));
+            src->~V();
+        }
+
+        static bool full(const Node *t) {
+            return t->cnt == (t->is_leaf ? (int) LEAF_CAP : (int) INNER_CAP);
+        }
+
+        static Leaf *new_leaf() {
+            Leaf *l = new Leaf;
+            l->is_leaf = true;
+            l->cnt = 0;
+            l->prev = l->next = nullptr;
+            return l;
+        }
+
+        static Inner *new_inner() {
+            Inner *in = new Inner;
+            in->is_leaf = false;
+            in->cnt = 0;
+            return in;
+        }
+
+        static void free_node(Node *t) {
+            if (t->is_leaf) delete static_cast<Leaf *>(t);
+            else delete static_cast<Inner *>(t);
+        }
+
+        //第一个不小于key的元素
+        static int lower_index(Leaf *l, const Key &key) {
+            int lo = 0, hi = l->cnt;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (Compare()(l->val()[mid].first, key)) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+
+        //key所在的儿子: 第一个大于key的关键字的位置
+        static int child_index(Inner *in, const Key &key) {
+            int lo = 0, hi = in->cnt;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (Compare()(key, in->key()[mid])) hi = mid;
+                else lo = mid + 1;
+            }
+            return lo;
+        }
+
+        Leaf *find_leaf(const Key &key, int &pos) const {
+            if (root == nullptr) return nullptr;
+            Node *t = root;
+            while (!t->is_leaf) t = static_cast<Inner *>(t)->child[child_index(static_cast<Inner *>(t), key)];
+            Leaf *l = static_cast<Leaf *>(t);
+            pos = lower_index(l, key);
+            if (pos == l->cnt || Compare()(key, l->val()[pos].first)) return nullptr;
+            return l;
+        }
+
+        //在p的第i个关键字处放入sep,右边多出儿子r
+        static void insert_key(Inner *p, int i, const Key &sep, Node *r) {
+            for (int j = p->cnt; j > i; j--) relocate(p->key() + j, p->key() + j - 1);
+            try {
+                new(p->key() + i) Key(sep);
+            } catch (...) {
+                for (int j = i; j < p->cnt; j++) relocate(p->key() + j, p->key() + j + 1);
+                throw;
+            }
+            for (int j = p->cnt + 1; j > i + 1; j--) p->child[j] = p->child[j - 1];
+            p->child[i + 1] = r;
+            p->cnt++;
+        }
+
+        //p不满,把满的儿子p->child[i]分成两半
+        void split_child(Inner *p, int i) {
+            Node *c = p->child[i];
+            if (c->is_leaf) {
+                Leaf *l = static_cast<Leaf *>(c), *r = new_leaf();
+                int half = l->cnt / 2;
+                try {
+                    insert_key(p, i, l->val()[half].first, r);
+                } catch (...) {
+                    delete r;
+                    throw;
+                }
+                for (int j = half; j < l->cnt; j++) relocate(r->val() + j - half, l->val() + j);
+                r->cnt = l->cnt - half;
+                l->cnt = half;
+                r->prev = l;
+                r->next = l->next;
+                if (l->next) l->next->prev = r;
+                else rear = r;
+                l->next = r;
+            } else {
+                Inner *l = static_cast<Inner *>(c), *r = new_inner();
+                int mid = l->cnt / 2;
+                try {
+                    insert_key(p, i, l->key()[mid], r);
+                } catch (...) {
+                    delete r;
+                    throw;
+                }
+                l->key()[mid].~Key();
+                for (int j = mid + 1; j < l->cnt; j++) relocate(r->key() + j - mid - 1, l->key() + j);
+                for (int j = mid + 1; j <= l->cnt; j++) r->child[j - mid - 1] = l->child[j];
+                r->cnt = l->cnt - mid - 1;
+                l->cnt = mid;
+            }
+        }
+
+        //从t的子树中删除key(key一定存在),儿子不够一半时向兄弟借或者合并
+        void erase_from(Node *t, const Key &key) {
+            if (t->is_leaf) {
+                Leaf *l = static_cast<Leaf *>(t);
+                int pos = lower_index(l, key);
+                l->val()[pos].~value_type();
+                for (int j = pos + 1; j < l->cnt; j++) relocate(l->val() + j - 1, l->val() + j);
+                l->cnt--;
+                return;
+            }
+            Inner *in = static_cast<Inner *>(t);
+            int i = child_index(in, key);
+            erase_from(in->child[i], key);
+            Node *c = in->child[i];
+            if (c->cnt < (c->is_leaf ? (int) LEAF_MIN : (int) INNER_MIN)) fix_child(in, i);
+        }
+
+        //把关键字换成sep,Key不一定能赋值,所以先析构再构造
+        static void set_key(Inner *p, int i, const Key &sep) {
+            Key tmp(sep);
+            p->key()[i].~Key();
+            new(p->key() + i) Key(std::move(tmp));
+        }
+
+        void fix_child(Inner *p, int i) {
+            int min = p->child[i]->is_leaf ? (int) LEAF_MIN : (int) INNER_MIN;
+            if (i > 0 && p->child[i - 1]->cnt > min) borrow_left(p, i);
+            else if (i < p->cnt && p->child[i + 1]->cnt > min) borrow_right(p, i);
+            else if (i > 0) merge_children(p, i - 1);
+            else merge_children(p, i);
+        }
+
+        //左兄弟的最后一个移到child[i]的最前面
+        void borrow_left(Inner *p, int i) {
+            Node *c = p->child[i], *s = p->child[i - 1];
+            if (c->is_leaf) {
+                Leaf *l = static_cast<Leaf *>(c), *ls = static_cast<Leaf *>(s);
+                for (int j = l->cnt; j > 0; j--) relocate(l->val() + j, l->val() + j - 1);
+                relocate(l->val(), ls->val() + ls->cnt - 1);
+                l->cnt++;
+                ls->cnt--;
+                set_key(p, i - 1, l->val()[0].first);
+            } else {
+                Inner *in = static_cast<Inner *>(c), *is = static_cast<Inner *>(s);
+                for (int j = in->cnt; j > 0; j--) relocate(in->key() + j, in->key() + j - 1);
+                for (int j = in->cnt + 1; j > 0; j--) in->child[j] = in->child[j - 1];
+                relocate(in->key(), p->key() + i - 1);
+                in->child[0] = is->child[is->cnt];
+                relocate(p->key() + i - 1, is->key() + is->cnt - 1);
+                in->cnt++;
+                is->cnt--;
+            }
+        }
+
+        //右兄弟的第一个移到child[i]的最后面
+        void borrow_right(Inner *p, int i) {
+            Node *c = p->child[i], *s = p->child[i + 1];
+            if (c->is_leaf) {
+                Leaf *l = static_cast<Leaf *>(c), *rs = static_cast<Leaf *>(s);
+                relocate(l->val() + l->cnt, rs->val());
+                for (int j = 1; j < rs->cnt; j++) relocate(rs->val() + j - 1, rs->val() + j);
+                l->cnt++;
+                rs->cnt--;
+                set_key(p, i, rs->val()[0].first);
+            } else {
+                Inner *in = static_cast<Inner *>(c), *is = static_cast<Inner *>(s);
+                relocate(in->key() + in->cnt, p->key() + i);
+                in->child[in->cnt + 1] = is->child[0];
+                relocate(p->key() + i, is->key());
+                for (int j = 1; j < is->cnt; j++) relocate(is->key() + j - 1, is->key() + j);
+                for (int j = 1; j <= is->cnt; j++) is->child[j - 1] = is->child[j];
+                in->cnt++;
+                is->cnt--;
+            }
+        }
+
+        //把child[i+1]合并到child[i]中,去掉关键字i
+        void merge_children(Inner *p, int i) {
+            Node *a = p->child[i], *b = p->child[i + 1];
+            if (a->is_leaf) {
+                Leaf *l = static_cast<Leaf *>(a), *r = static_cast<Leaf *>(b);
+                for (int j = 0; j < r->cnt; j++) relocate(l->val() + l->cnt + j, r->val() + j);
+                l->cnt += r->cnt;
+                l->next = r->next;
+                if (r->next) r->next->prev = l;
+                else rear = l;
+                p->key()[i].~Key();
+            } else {
+                Inner *l = static_cast<Inner *>(a), *r = static_cast<Inner *>(b);
+                relocate(l->key() + l->cnt, p->key() + i);
+                for (int j = 0; j < r->cnt; j++) relocate(l->key() + l->cnt + 1 + j, r->key() + j);
+                for (int j = 0; j <= r->cnt; j++) l->child[l->cnt + 1 + j] = r->child[j];
+                l->cnt += r->cnt + 1;
+            }
+            free_node(b);
+            for (int j = i + 1; j < p->cnt; j++) relocate(p->key() + j - 1, p->key() + j);
+            for (int j = i + 2; j <= p->cnt; j++) p->child[j - 1] = p->child[j];
+            p->cnt--;
+        }
+
+        void destroy(Node *t) {
+            if (t->is_leaf) {
+                Leaf *l = static_cast<Leaf *>(t);
+                for (int i = 0; i < l->cnt; i++) l->val()[i].~value_type();
+                delete l;
+                return;
+            }
+            Inner *in = static_cast<Inner *>(t);
+            for (int i = 0; i <= in->cnt; i++) destroy(in->child[i]);
+            for (int i = 0; i < in->cnt; i++) in->key()[i].~Key();
+            delete in;
+        }
+
+        //按中序复制,同时把叶子重新串起来
+        Node *clone(Node *t, Leaf *&last) {
+            if (t->is_leaf) {
+                Leaf *src = static_cast<Leaf *>(t), *l = new_leaf();
+                try {
+                    for (; l->cnt < src->cnt; l->cnt++) new(l->val() + l->cnt) value_type(src->val()[l->cnt]);
+                } catch (...) {
+                    destroy(l);
+                    throw;
+                }
+                l->prev = last;
+                if (last) last->next = l;
+                else head = l;
+                last = l;
+                return l;
+            }
+            Inner *src = static_cast<Inner *>(t), *in = new_inner();
+            try {
+                for (; in->cnt < src->cnt; in->cnt++) new(in->key() + in->cnt) Key(src->key()[in->cnt]);
+            } catch (...) {
+                for (int i = 0; i < in->cnt; i++) in->key()[i].~Key();
+                delete in;
+                throw;
+            }
+            int done = 0;
+            try {
+                for (; done <= src->cnt; done++) in->child[done] = clone(src->child[done], last);
+            } catch (...) {
+                //叶子的链表由copy_from重置
+                for (int i = 0; i < done; i++) destroy(in->child[i]);
+                for (int i = 0; i < in->cnt; i++) in->key()[i].~Key();
+                delete in;
+                throw;
+            }
+            return in;
+        }
+
+        void copy_from(const btree_map &other) {
+            if (other.root == nullptr) return;
+            Leaf *last = nullptr;
+            try {
+                root = clone(other.root, last);
+            } catch (...) {
+                head = rear = nullptr;
+                throw;
+            }
+            rear = last;
+            len = other.len;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,658 @@
+/**
+ * a sorted map for many readers and few writers
+ */
+#ifndef SJTU_CONCURRENT_MAP_HPP
+#define SJTU_CONCURRENT_MAP_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * a sorted map whose readers never wait for a lock.
+ * the tree (a left-leaning red-black tree) is never changed in place: a writer
+ * copies the nodes on the path it touches, builds a new version of the tree
+ * and publishes it through an atomic pointer, so a reader always sees one
+ * complete version. writers are serialized by a mutex.
+ * a replaced node is freed only when every reader that started before its
+ * replacement has finished (epoch-based reclamation).
+ * take_snapshot() pins one version for a consistent multi-step read; while it
+ * is alive nothing retired after it is freed, so keep it short.
+ * at most READER_SLOTS readers run at the same time, more ones spin until a
+ * slot is free. the map must outlive all its snapshots.
+ */
+    template<
+            class Key,
+            class T,
+            class Compare = std::less<Key>
+    >
+    class concurrent_map {
+    public:
+        typedef pair<const Key, T> value_type;
+
+        enum { READER_SLOTS = 64 };
+
+    private:
+        //被替换下来的节点攒够这么多再回收一次
+        enum { RECLAIM = 256 };
+
+        //stamp是创建它的写操作的编号,同一次写操作里可以直接修改;0表示这次写操作中被丢掉了
+        struct Node {
+            Node *left, *right;
+            unsigned long long stamp;
+            bool red;
+            value_type value;
+
+            Node(const value_type &v, bool _red, Node *l, Node *r, unsigned long long _stamp) :
+                    left(l), right(r), stamp(_stamp), red(_red), value(v) {}
+        };
+
+        //一个版本: 根和元素个数一起发布
+        struct Version {
+            Node *root;
+            size_t len;
+        };
+
+        //等待回收的节点或版本,epoch是它被替换时的纪元
+        struct Retired {
+            Node *node;
+            Version *ver;
+            unsigned long long epoch;
+        };
+
+        //写者自己用的可增长数组
+        template<class E>
+        struct buffer {
+            E *a;
+            size_t len, cap;
+
+            buffer() : a(nullptr), len(0), cap(0) {}
+
+            ~buffer() {
+                delete[] a;
+            }
+
+            void reserve(size_t n) {
+                if (n <= cap) return;
+                if (n < cap * 2) n = cap * 2;
+                E *tmp = new E[n];
+                for (size_t i = 0; i < len; i++) tmp[i] = a[i];
+                delete[] a;
+                a = tmp;
+                cap = n;
+            }
+
+            void push(const E &e) {
+                if (len == cap) reserve(len + 16);
+                a[len++] = e;
+            }
+        };
+
+        //读者占一个槽,里面是它开始时的纪元,0表示空闲;每个槽独占一条缓存行
+        struct alignas(64) Slot {
+            std::atomic<unsigned long long> epoch;
+        };
+
+        std::atomic<Version *> current;
+        std::atomic<unsigned long long> global_epoch;
+        std::atomic<size_t> count_hint;
+        mutable Slot slots[READER_SLOTS];
+
+        //以下只有拿着writer的线程访问
+        std::mutex writer;
+        unsigned long long txn;
+        buffer<Node *> fresh;     //这次写操作新建的节点
+        buffer<Node *> replaced;  //这次写操作中从旧版本里拿掉的节点
+        buffer<Retired> retired;
+
+    public:
+        class const_iterator;
+
+        /**
+         * a pinned version of the map. reading through it never takes a lock
+         * and sees none of the writes made after it was taken.
+         * references and iterators obtained from it are valid while it lives.
+         */
+        class snapshot {
+            friend class concurrent_map;
+
+        private:
+            const concurrent_map *owner;
+            int slot;
+            const Version *ver;
+
+            snapshot(const concurrent_map *_owner, int _slot, const Version *_ver) :
+                    owner(_owner), slot(_slot), ver(_ver) {}
+
+        public:
+            snapshot(const snapshot &other) = delete;
+
+            snapshot &operator=(const snapshot &other) = delete;
+
+            snapshot(snapshot &&other) noexcept : owner(other.owner), slot(other.slot), ver(other.ver) {
+                other.owner = nullptr;
+            }
+
+            ~snapshot() {
+                if (owner) owner->unpin(slot);
+            }
+
+            const_iterator begin() const {
+                const Node *p = ver->root;
+                if (p) while (p->left) p = p->left;
+                return const_iterator(ver->root, p);
+            }
+
+            const_iterator end() const {
+                return const_iterator(ver->root, nullptr);
+            }
+
+            const_iterator find(const Key &key) const {
+                return const_iterator(ver->root, locate(ver->root, key));
+            }
+
+            size_t count(const Key &key) const {
+                return locate(ver->root, key) ? 1 : 0;
+            }
+
+            /**
+             * access the value of key.
+             * throw index_out_of_bound if key is not in this version.
+             */
+            const T &at(const Key &key) const {
+                const Node *p = locate(ver->root, key);
+                if (!p) throw index_out_of_bound();
+                return p->value.second;
+            }
+
+            size_t size() const {
+                return ver->len;
+            }
+
+            bool empty() const {
+                return !ver->len;
+            }
+        };
+
+        /**
+         * a forward iterator over a snapshot.
+         * the nodes have no parent pointers, so ++ looks for the successor from
+         * the root when the current node has no right subtree: O(log n) each.
+         */
+        class const_iterator {
+            friend class snapshot;
+
+        private:
+            const Node *root, *p;  //p为空表示end
+
+            const_iterator(const Node *_root, const Node *_p) : root(_root), p(_p) {}
+
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef typename concurrent_map::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const value_type *pointer;
+            typedef const value_type &reference;
+
+            const_iterator() : root(nullptr), p(nullptr) {}
+
+            /**
+             * throw invalid_iterator if it is end().
+             */
+            const_iterator &operator++() {
+                if (!p) throw invalid_iterator();
+                if (p->right) {
+                    p = p->right;
+                    while (p->left) p = p->left;
+                    return *this;
+                }
+                //后继是查找p时最后一次向左走经过的节点
+                const Node *succ = nullptr;
+                for (const Node *t = root; t != p;) {
+                    if (Compare()(p->value.first, t->value.first)) {
+                        succ = t;
+                        t = t->left;
+                    } else t = t->right;
+                }
+                p = succ;
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            const value_type &operator*() const {
+                if (!p) throw invalid_iterator();
+                return p->value;
+            }
+
+            const value_type *operator->() const {
+                if (!p) throw invalid_iterator();
+                return &p->value;
+            }
+
+            bool operator==(const const_iterator &rhs) const {
+                return p == rhs.p && (p || root == rhs.root);
+            }
+
+            bool operator!=(const const_iterator &rhs) const {
+                return !(*this == rhs);
+            }
+        };
+
+        //-------------------------------------------------------------------
+
+        concurrent_map() : current(new Version()), global_epoch(1), count_hint(0), txn(0) {
+            for (int i = 0; i < READER_SLOTS; i++) slots[i].epoch.store(0, std::memory_order_relaxed);
+        }
+
+        concurrent_map(const concurrent_map &other) = delete;
+
+        concurrent_map &operator=(const concurrent_map &other) = delete;
+
+        //此时不能再有读者和写者
+        ~concurrent_map() {
+            Version *v = current.load(std::memory_order_relaxed);
+            destroy(v->root);
+            delete v;
+            for (size_t i = 0; i < retired.len; i++) {
+                delete retired.a[i].node;
+                delete retired.a[i].ver;
+            }
+        }
+
+        /**
+         * pin the current version for reading.
+         */
+        snapshot take_snapshot() const {
+            int s = pin();
+            return snapshot(this, s, current.load());
+        }
+
+        size_t count(const Key &key) const {
+            int s = pin();
+            size_t res = locate(current.load()->root, key) ? 1 : 0;
+            unpin(s);
+            return res;
+        }
+
+        /**
+         * copy the value of key into out.
+         * @return false if key is not in the map.
+         */
+        bool get(const Key &key, T &out) const {
+            int s = pin();
+            try {
+                const Node *p = locate(current.load()->root, key);
+                if (p) out = p->value.second;
+                unpin(s);
+                return p != nullptr;
+            } catch (...) {
+                unpin(s);
+                throw;
+            }
+        }
+
+        /**
+         * return a copy of the value of key.
+         * throw index_out_of_bound if key is not in the map.
+         */
+        T at(const Key &key) const {
+            snapshot snap = take_snapshot();
+            return snap.at(key);
+        }
+
+        //写者刚刚完成时的元素个数,读者同时在写的时候只是一个近似值
+        size_t size() const {
+            return count_hint.load(std::memory_order_relaxed);
+        }
+
+        bool empty() const {
+            return !size();
+        }
+
+        /**
+         * insert value if its key is not in the map.
+         * @return true if it was inserted.
+         * if a copy throws the map is unchanged.
+         */
+        bool insert(const value_type &value) {
+            std::lock_guard<std::mutex> lock(writer);
+            Version *v = current.load(std::memory_order_relaxed);
+            if (locate(v->root, value.first)) return false;
+            begin_write();
+            try {
+                Node *root = put(v->root, value);
+                publish(blacken(root), v->len + 1);
+            } catch (...) {
+                rollback();
+                throw;
+            }
+            return true;
+        }
+
+        /**
+         * set the value of key, inserting it if needed.
+         * @return true if key was not in the map.
+         */
+        bool assign(const Key &key, const T &value) {
+            std::lock_guard<std::mutex> lock(writer);
+            Version *v = current.load(std::memory_order_relaxed);
+            bool found = locate(v->root, key) != nullptr;
+            begin_write();
+            try {
+                //key已经存在时树的形状不变,只复制到它的路径
+                Node *root = found ? reassign(v->root, key, value) : put(v->root, value_type(key, value));
+                publish(blacken(root), v->len + !found);
+            } catch (...) {
+                rollback();
+                throw;
+            }
+            return !found;
+        }
+
+        /**
+         * erase the element with key.
+         * @return the number of elements erased (0 or 1).
+         */
+        size_t erase(const Key &key) {
+            std::lock_guard<std::mutex> lock(writer);
+            Version *v = current.load(std::memory_order_relaxed);
+            if (!locate(v->root, key)) return 0;
+            begin_write();
+            try {
+                Node *root = v->root;
+                //根的两个儿子都是黑的时先把根染红,保证向下走时当前节点或者它的左儿子是红的
+                if (!red(root->left) && !red(root->right)) {
+                    root = own(root);
+                    root->red = true;
+                }
+                root = remove(root, key);
+                publish(blacken(root), v->len - 1);
+            } catch (...) {
+                rollback();
+                throw;
+            }
+            return 1;
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(writer);
+            Version *v = current.load(std::memory_order_relaxed);
+            begin_write();
+            try {
+                discard(v->root);
+                publish(nullptr, 0);
+            } catch (...) {
+                rollback();
+                throw;
+            }
+        }
+
+    private:
+        static bool red(const Node *p) {
+            return p && p->red;
+        }
+
+        //每层只比较一次,记下最后一个不小于key的节点,最后再判断一次
+        static const Node *locate(const Node *p, const Key &key) {
+            const Node *cand = nullptr;
+            while (p) {
+                if (Compare()(p->value.first, key)) p = p->right;
+                else {
+                    cand = p;
+                    p = p->left;
+                }
+            }
+            return cand && !Compare()(key, cand->value.first) ? cand : nullptr;
+        }
+
+        //---------------------------- 纪元 ----------------------------
+
+        //先在槽里写下当前的纪元,再读版本,写者就不会回收这之后可能读到的节点
+        int pin() const {
+            static std::atomic<unsigned> threads(0);
+            static thread_local unsigned hint = threads.fetch_add(1, std::memory_order_relaxed);
+            for (unsigned i = 0;; i++) {
+                unsigned s = (hint + i) % READER_SLOTS;
+                unsigned long long expect = 0;
+                if (slots[s].epoch.load(std::memory_order_relaxed) == 0 &&
+                    slots[s].epoch.compare_exchange_strong(expect, global_epoch.load())) {
+                    hint = s;
+                    return (int) s;
+                }
+                if (i % READER_SLOTS == READER_SLOTS - 1) std::this_thread::yield();
+            }
+        }
+
+        void unpin(int s) const {
+            slots[s].epoch.store(0, std::memory_order_release);
+        }
+
+        //所有读者开始时的纪元都比它大的节点就没有人能读到了
+        void reclaim() {
+            unsigned long long lo = ~0ull;
+            for (int i = 0; i < READER_SLOTS; i++) {
+                unsigned long long e = slots[i].epoch.load();
+                if (e && e < lo) lo = e;
+            }
+            size_t k = 0;
+            for (size_t i = 0; i < retired.len; i++) {
+                if (retired.a[i].epoch < lo) {
+                    delete retired.a[i].node;
+                    delete retired.a[i].ver;
+                } else retired.a[k++] = retired.a[i];
+            }
+            retired.len = k;
+        }
+
+        //---------------------------- 写操作 ----------------------------
+
+        void begin_write() {
+            txn++;
+            fresh.len = replaced.len = 0;
+        }
+
+        //发布之后不能再抛异常,所以先申请好所有要用的内存
+        void publish(Node *root, size_t len) {
+            retired.reserve(retired.len + replaced.len + 1);
+            Version *nv = new Version();
+            nv->root = root;
+            nv->len = len;
+            Version *old = current.load(std::memory_order_relaxed);
+            current.store(nv);
+            count_hint.store(len, std::memory_order_relaxed);
+            //这次新建又丢掉的节点从来没有被读者看到过
+            for (size_t i = 0; i < fresh.len; i++)
+                if (fresh.a[i]->stamp == 0) delete fresh.a[i];
+            unsigned long long e = global_epoch.load();
+            for (size_t i = 0; i < replaced.len; i++) retired.a[retired.len++] = Retired{replaced.a[i], nullptr, e};
+            retired.a[retired.len++] = Retired{nullptr, old, e};
+            fresh.len = replaced.len = 0;
+            //之后开始的读者的纪元都大于e,它们只能读到新版本
+            global_epoch.fetch_add(1);
+            if (retired.len >= RECLAIM) reclaim();
+        }
+
+        //旧版本没有动过,删掉新建的节点就回到了原来的状态
+        void rollback() {
+            for (size_t i = 0; i < fresh.len; i++) delete fresh.a[i];
+            fresh.len = replaced.len = 0;
+        }
+
+        //先占好位置,new失败时留下的是空指针
+        Node *make(const value_type &v, bool is_red, Node *l, Node *r) {
+            fresh.push(nullptr);
+            return fresh.a[fresh.len - 1] = new Node(v, is_red, l, r, txn);
+        }
+
+        //要修改旧版本的节点时先复制一份
+        Node *own(Node *p) {
+            if (p->stamp == txn) return p;
+            Node *c = make(p->value, p->red, p->left, p->right);
+            replaced.push(p);
+            return c;
+        }
+
+        //p不在新版本里了
+        void drop(Node *p) {
+            if (p->stamp == txn) p->stamp = 0;
+            else replaced.push(p);
+        }
+
+        void discard(Node *p) {
+            if (!p) return;
+            discard(p->left);
+            discard(p->right);
+            replaced.push(p);
+        }
+
+        static void destroy(Node *p) {
+            if (!p) return;
+            destroy(p->left);
+            destroy(p->right);
+            delete p;
+        }
+
+        Node *blacken(Node *root) {
+            if (!red(root)) return root;
+            root = own(root);
+            root->red = false;
+            return root;
+        }
+
+        //以下的h都已经属于这次写操作
+        Node *rotate_left(Node *h) {
+            Node *x = own(h->right);
+            h->right = x->left;
+            x->left = h;
+            x->red = h->red;
+            h->red = true;
+            return x;
+        }
+
+        Node *rotate_right(Node *h) {
+            Node *x = own(h->left);
+            h->left = x->right;
+            x->right = h;
+            x->red = h->red;
+            h->red = true;
+            return x;
+        }
+
+        void flip(Node *h) {
+            h->left = own(h->left);
+            h->right = own(h->right);
+            h->red = !h->red;
+            h->left->red = !h->left->red;
+            h->right->red = !h->right->red;
+        }
+
+        //红的右儿子转到左边,连续两个红的左儿子转成一个4-节点,再把4-节点拆开
+        Node *balance(Node *h) {
+            if (red(h->right) && !red(h->left)) h = rotate_left(h);
+            if (red(h->left) && red(h->left->left)) h = rotate_right(h);
+            if (red(h->left) && red(h->right)) flip(h);
+            return h;
+        }
+
+        //h和h的左儿子都是黑的时,让左儿子或它的一个儿子变红
+        Node *move_red_left(Node *h) {
+            flip(h);
+            if (red(h->right->left)) {
+                h->right = rotate_right(h->right);
+                h = rotate_left(h);
+                flip(h);
+            }
+            return h;
+        }
+
+        Node *move_red_right(Node *h) {
+            flip(h);
+            if (red(h->left->left)) {
+                h = rotate_right(h);
+                flip(h);
+            }
+            return h;
+        }
+
+        //调用前已经确认key不存在
+        Node *put(Node *h, const value_type &v) {
+            if (!h) return make(v, true, nullptr, nullptr);
+            h = own(h);
+            if (Compare()(v.first, h->value.first)) h->left = put(h->left, v);
+            else h->right = put(h->right, v);
+            return balance(h);
+        }
+
+        //调用前已经确认key存在
+        Node *reassign(Node *h, const Key &key, const T &value) {
+            if (Compare()(key, h->value.first)) {
+                h = own(h);
+                h->left = reassign(h->left, key, value);
+                return h;
+            }
+            if (Compare()(h->value.first, key)) {
+                h = own(h);
+                h->right = reassign(h->right, key, value);
+                return h;
+            }
+            //key是const的,换一个新节点
+            Node *n = make(value_type(h->value.first, value), h->red, h->left, h->right);
+            drop(h);
+            return n;
+        }
+
+        Node *remove_min(Node *h) {
+            //左倾红黑树中没有左儿子的节点也没有右儿子
+            if (!h->left) {
+                drop(h);
+                return nullptr;
+            }
+            h = own(h);
+            if (!red(h->left) && !red(h->left->left)) h = move_red_left(h);
+            h->left = remove_min(h->left);
+            return balance(h);
+        }
+
+        //调用前已经确认key存在
+        Node *remove(Node *h, const Key &key) {
+            h = own(h);
+            if (Compare()(key, h->value.first)) {
+                if (!red(h->left) && !red(h->left->left)) h = move_red_left(h);
+                h->left = remove(h->left, key);
+            } else {
+                if (red(h->left)) h = rotate_right(h);
+                if (!Compare()(h->value.first, key) && !h->right) {
+                    drop(h);
+                    return nullptr;
+                }
+                if (!red(h->right) && !red(h->right->left)) h = move_red_right(h);
+                if (!Compare()(h->value.first, key)) {
+                    //用右子树的最小值代替h
+                    Node *m = h->right;
+                    while (m->left) m = m->left;
+                    Node *n = make(m->value, h->red, h->left, nullptr);
+                    n->right = remove_min(h->right);
+                    drop(h);
+                    h = n;
+                } else h->right = remove(h->right, key);
+            }
+            return balance(h);
+        }
+    };
+
+}
+
+#endif
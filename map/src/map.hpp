@@ -8,16 +8,287 @@
 #include <functional>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
 #include "utility.hpp"
 #include "exceptions.hpp"
 
 namespace sjtu {
+
+/**
+ * a slab allocator for the nodes of one container.
+ * single objects are carved from chunks that double in size and recycled
+ * through a free list; release() gives every chunk back at once, so a map
+ * can be cleared without visiting its nodes (when they need no destructor).
+ * the chunks belong to this object: a copy starts with an empty pool, and
+ * only the allocator which allocated a node may deallocate it.
+ */
+    template<class T>
+    class slab_allocator {
+        union Slot {
+            Slot *next;
+            alignas(T) unsigned char data[sizeof(T)];
+        };
+
+        struct Chunk {
+            Chunk *next;
+            Slot *slots;
+        };
+
+    private:
+        Chunk *chunks;
+        Slot *free_list, *cur, *cur_end;
+        size_t next_size;
+
+    public:
+        typedef T value_type;
+
+        slab_allocator() : chunks(nullptr), free_list(nullptr), cur(nullptr), cur_end(nullptr), next_size(64) {}
+
+        //不共享内存块,复制出的是一个空的池
+        slab_allocator(const slab_allocator &) : slab_allocator() {}
+
+        template<class U>
+        slab_allocator(const slab_allocator<U> &) : slab_allocator() {}
+
+        slab_allocator &operator=(const slab_allocator &) {
+            return *this;
+        }
+
+        //移动时把内存块一起交出去,原来的分配器变成空的池
+        slab_allocator(slab_allocator &&other) noexcept
+                : chunks(other.chunks), free_list(other.free_list), cur(other.cur), cur_end(other.cur_end),
+                  next_size(other.next_size) {
+            other.chunks = nullptr;
+            other.free_list = other.cur = other.cur_end = nullptr;
+            other.next_size = 64;
+        }
+
+        slab_allocator &operator=(slab_allocator &&other) noexcept {
+            if (this == &other) return *this;
+            release();
+            chunks = other.chunks;
+            free_list = other.free_list;
+            cur = other.cur;
+            cur_end = other.cur_end;
+            next_size = other.next_size;
+            other.chunks = nullptr;
+            other.free_list = other.cur = other.cur_end = nullptr;
+            other.next_size = 64;
+            return *this;
+        }
+
+        ~slab_allocator() {
+            release();
+        }
+
+        //一次申请多个对象的情况很少,直接用operator new
+        T *allocate(size_t n) {
+            if (n != 1) return static_cast<T *>(::operator new(n * sizeof(T)));
+            if (free_list) {
+                Slot *s = free_list;
+                free_list = s->next;
+                return reinterpret_cast<T *>(s);
+            }
+            if (cur == cur_end) {
+                new_chunk(next_size);
+                if (next_size < (1u << 16)) next_size *= 2;
+            }
+            return reinterpret_cast<T *>(cur++);
+        }
+
+        /**
+         * make sure the next n single allocations are carved from one
+         * contiguous chunk (when the free list is empty), so a tree built
+         * at once is laid out in allocation order.
+         * the unused tail of the current chunk is given up until release().
+         */
+        void reserve(size_t n) {
+            if ((size_t) (cur_end - cur) >= n) return;
+            new_chunk(n > next_size ? n : next_size);
+        }
+
+        void deallocate(T *p, size_t n) {
+            if (n != 1) {
+                ::operator delete(p);
+                return;
+            }
+            Slot *s = reinterpret_cast<Slot *>(p);
+            s->next = free_list;
+            free_list = s;
+        }
+
+        //一次性释放所有的块,之前分配出去的对象全部失效
+        void release() {
+            while (chunks) {
+                Chunk *c = chunks;
+                chunks = c->next;
+                delete[] c->slots;
+                delete c;
+            }
+            free_list = cur = cur_end = nullptr;
+            next_size = 64;
+        }
+
+    private:
+        void new_chunk(size_t n) {
+            Chunk *c = new Chunk;
+            try {
+                c->slots = new Slot[n];
+            } catch (...) {
+                delete c;
+                throw;
+            }
+            c->next = chunks;
+            chunks = c;
+            cur = c->slots;
+            cur_end = cur + n;
+        }
+
+    public:
+        bool operator==(const slab_allocator &other) const {
+            return this == &other;
+        }
+
+        bool operator!=(const slab_allocator &other) const {
+            return this != &other;
+        }
+    };
+
+    //能整块释放的分配器在清空时不用逐个归还节点
+    template<class A>
+    struct is_slab_allocator : std::false_type {};
+
+    template<class U>
+    struct is_slab_allocator<slab_allocator<U> > : std::true_type {};
+
+    template<class A>
+    void release_all(A &) {}
+
+    template<class U>
+    void release_all(slab_allocator<U> &a) {
+        a.release();
+    }
+
+    //一次建好整棵树之前,让节点落在一块连续的内存里
+    template<class A>
+    void reserve_nodes(A &, size_t) {}
+
+    template<class U>
+    void reserve_nodes(slab_allocator<U> &a, size_t n) {
+        a.reserve(n);
+    }
+
+    /**
+     * augmentations of the red-black tree inside map.
+     * no_statistics:    nothing is added (default).
+     * order_statistics: every node records the size of its subtree, which
+     *                   gives rank/select/iterator difference in O(log n).
+     * threaded_links:   every node links to its in-order neighbours, so
+     *                   iterator increment and decrement are O(1).
+     * augment<A, B...>: several of them at once.
+     */
+    struct no_statistics {};
+    struct order_statistics {};
+    struct threaded_links {};
+
+    template<class... Tags>
+    struct augment {};
+
+    template<class Tag, class... Tags>
+    struct has_tag : std::false_type {};
+
+    template<class Tag, class First, class... Rest>
+    struct has_tag<Tag, First, Rest...>
+            : std::integral_constant<bool, std::is_same<Tag, First>::value || has_tag<Tag, Rest...>::value> {};
+
+    template<class Augment, class Tag>
+    struct has_augment : std::is_same<Augment, Tag> {};
+
+    template<class... Tags, class Tag>
+    struct has_augment<augment<Tags...>, Tag> : has_tag<Tag, Tags...> {};
+
+    //开启顺序统计时,节点记录子树大小;否则是空基类,读到的大小总是0
+    template<bool Enabled>
+    struct subtree_size {
+        size_t get_size() const {
+            return 0;
+        }
+
+        void set_size(size_t) {}
+    };
+
+    template<>
+    struct subtree_size<true> {
+        size_t size;
+
+        subtree_size() : size(1) {}
+
+        size_t get_size() const {
+            return size;
+        }
+
+        void set_size(size_t s) {
+            size = s;
+        }
+    };
+
+    //开启线索时,节点记录中序的前驱和后继;否则是空基类
+    template<bool Enabled, class Node>
+    struct thread_links {
+        Node *get_prev() const {
+            return nullptr;
+        }
+
+        Node *get_next() const {
+            return nullptr;
+        }
+
+        void set_prev(Node *) {}
+
+        void set_next(Node *) {}
+    };
+
+    template<class Node>
+    struct thread_links<true, Node> {
+        Node *prev, *next;
+
+        thread_links() : prev(nullptr), next(nullptr) {}
+
+        //复制节点时不复制链接,由所在的树重新串起来
+        thread_links(const thread_links &) : prev(nullptr), next(nullptr) {}
+
+        Node *get_prev() const {
+            return prev;
+        }
+
+        Node *get_next() const {
+            return next;
+        }
+
+        void set_prev(Node *p) {
+            prev = p;
+        }
+
+        void set_next(Node *n) {
+            next = n;
+        }
+    };
+
     template<
             class Key,
             class T,
-            class Compare = std::less<Key>
+            class Compare = std::less<Key>,
+            class Alloc = slab_allocator<pair<const Key, T> >,
+            class Augment = no_statistics
     >
     class map {
+        static const bool ranked = has_augment<Augment, order_statistics>::value;
+        static const bool threaded = has_augment<Augment, threaded_links>::value;
+
     public:
 
         typedef pair<const Key, T> value_type;
@@ -25,93 +296,351 @@ namespace sjtu {
             RED, BLACK
         };
 
-        struct NODE {
-            value_type *data;
+        //value_type直接存在节点里,只申请一次内存,比较时也不用多跳一次指针
+        //用原始内存存放,value_type不需要默认构造函数
+        //默认构造的节点(end_node)里没有value_type,要用destroy删除有值的节点
+        struct emplace_tag {};
+
+        struct NODE : subtree_size<ranked>, thread_links<threaded, NODE> {
             NODE *left, *right, *fa;
             COLOR color;
+            alignas(value_type) unsigned char buf[sizeof(value_type)];
 
             //默认构造函数
-            NODE() : data(nullptr), left(nullptr), right(nullptr), fa(nullptr), color(RED) {};
+            NODE() : left(nullptr), right(nullptr), fa(nullptr), color(RED) {};
 
             NODE(const value_type &_data, COLOR c = RED, NODE *f = nullptr, NODE *lt = nullptr, NODE *rt = nullptr)
-                    : fa(f), left(lt), right(rt), color(c) {
-                data = new value_type(_data);
+                    : left(lt), right(rt), fa(f), color(c) {
+                new(buf) value_type(_data);
             }
 
             NODE(const Key &_key, const T &_T, COLOR c = RED, NODE *f = nullptr, NODE *lt = nullptr, NODE *rt = nullptr)
-                    : fa(f), left(lt), right(rt), color(c) {
-                data = new value_type(_key, _T);
+                    : left(lt), right(rt), fa(f), color(c) {
+                new(buf) value_type(_key, _T);
+            }
+
+            //用任意参数就地构造value_type,给emplace用
+            template<class... Args>
+            NODE(emplace_tag, Args &&...args) : left(nullptr), right(nullptr), fa(nullptr), color(RED) {
+                new(buf) value_type(std::forward<Args>(args)...);
             }
 
             //复制构造函数，新节点的左右孩子在具体函数中处理
-            NODE(const NODE &other) : fa(nullptr), left(nullptr), right(nullptr), color(other.color) {
-                data = new value_type(*(other.data));
+            NODE(const NODE &other) : subtree_size<ranked>(other), thread_links<threaded, NODE>(other), left(nullptr),
+                                      right(nullptr), fa(nullptr), color(other.color) {
+                new(buf) value_type(*other.data());
             }
 
-            ~NODE() {
-                if (data) {
-                    delete data;
-                    data = nullptr;
-                }
+            value_type *data() {
+                return reinterpret_cast<value_type *>(buf);
+            }
+
+            const value_type *data() const {
+                return reinterpret_cast<const value_type *>(buf);
             }
         };
 
+        //节点从Alloc换成NODE类型之后的分配器中申请,end_node不带数据,仍然用new
+        typedef typename std::allocator_traits<Alloc>::template rebind_alloc<NODE> node_allocator;
+        typedef std::allocator_traits<node_allocator> node_traits;
+
         class RedBlackTree {
         public:
             NODE *root, *end_node, *head, *rear;
             int len;
+            node_allocator alloc; //每棵树有自己的分配器,复制时不共享
 
             //默认构造
             RedBlackTree() : root(nullptr), len(0), head(nullptr), rear(nullptr){
-                end_node = new NODE;
+                end_node = new_end_node();
             }
 
             RedBlackTree(NODE *t) : root(t), len(0), head(nullptr), rear(nullptr) {
-                end_node = new NODE;
+                end_node = new_end_node();
             }
 
             //复制构造
-            RedBlackTree(const RedBlackTree &other) : root(nullptr), len(other.len) {
-                clone(root, other.root);
-                head = front();  rear = back();
-                end_node = new NODE;
+            RedBlackTree(const RedBlackTree &other) : root(nullptr), len(0), head(nullptr), rear(nullptr) {
+                end_node = new_end_node();
+                try {
+                    clone(other);
+                } catch (...) {
+                    delete end_node;
+                    throw;
+                }
             }
 
             RedBlackTree &operator=(const RedBlackTree &other) {
                 //防止自身赋值
                 if (this == &other) return *this;
-                make_empty(root);
+                clear();
                 delete end_node;
-                end_node = new NODE;
+                end_node = new_end_node();
 
-                clone(root, other.root);
-                head = front(); rear = back();
+                clone(other);
+                return *this;
+            }
+
+            //整棵树连同分配器一起交出去,other换上新的end_node
+            RedBlackTree(RedBlackTree &&other)
+                    : root(other.root), end_node(other.end_node), head(other.head), rear(other.rear), len(other.len),
+                      alloc(std::move(other.alloc)) {
+                other.end_node = new_end_node();
+                other.root = other.head = other.rear = nullptr;
+                other.len = 0;
+            }
+
+            RedBlackTree &operator=(RedBlackTree &&other) {
+                if (this == &other) return *this;
+                clear();
+                alloc = std::move(other.alloc);
+                std::swap(end_node, other.end_node);
+                root = other.root;
+                head = other.head;
+                rear = other.rear;
                 len = other.len;
+                other.root = other.head = other.rear = nullptr;
+                other.len = 0;
                 return *this;
             }
 
+            //开启线索时,end_node是循环链表的哨兵: end_node->next是head,end_node->prev是rear
+            static NODE *new_end_node() {
+                NODE *e = new NODE;
+                e->set_prev(e);
+                e->set_next(e);
+                return e;
+            }
+
+            //把x接在p的后面
+            static void link_after(NODE *p, NODE *x) {
+                if (!threaded) return;
+                NODE *n = p->get_next();
+                x->set_prev(p);
+                x->set_next(n);
+                n->set_prev(x);
+                p->set_next(x);
+            }
+
+            static void unlink(NODE *x) {
+                if (!threaded) return;
+                x->get_prev()->set_next(x->get_next());
+                x->get_next()->set_prev(x->get_prev());
+            }
+
+            //只按树的形状找中序的后继/前驱,没有就返回空
+            static NODE *tree_next(NODE *p) {
+                if (p->right) {
+                    p = p->right;
+                    while (p->left) p = p->left;
+                    return p;
+                }
+                while (p->fa && p->fa->right == p) p = p->fa;
+                return p->fa;
+            }
+
+            static NODE *tree_prev(NODE *p) {
+                if (p->left) {
+                    p = p->left;
+                    while (p->right) p = p->right;
+                    return p;
+                }
+                while (p->fa && p->fa->left == p) p = p->fa;
+                return p->fa;
+            }
+
+            //迭代器的移动,p不是end_node;最后一个节点的后继是end_node
+            NODE *next(NODE *p) const {
+                if (threaded) return p->get_next();
+                if (p == rear) return end_node;
+                return tree_next(p);
+            }
+
+            //p不是head;end_node的前驱是rear
+            NODE *prev(NODE *p) const {
+                if (threaded) return p->get_prev();
+                if (p == end_node) return rear;
+                return tree_prev(p);
+            }
+
+            //按中序把整棵树重新串起来,复制或者整体建树之后用
+            void relink() {
+                if (!threaded) return;
+                NODE *last = end_node;
+                for (NODE *t = front(); t; t = tree_next(t)) {
+                    last->set_next(t);
+                    t->set_prev(last);
+                    last = t;
+                }
+                last->set_next(end_node);
+                end_node->set_prev(last);
+            }
+
             ~RedBlackTree() {
-                make_empty(root);
-                len = 0;
-                head = nullptr; rear = nullptr;
+                clear();
                 if (end_node) {
                     delete end_node;
                     end_node = nullptr;
                 }
             }
 
-            bool equal(const Key &a, const Key &b) const {
-                return !(Compare()(a, b) || Compare()(b, a));
+            static size_t size(const NODE *t) {
+                return t ? t->get_size() : 0;
+            }
+
+            //旋转之后由儿子重新算出t的子树大小
+            static void update(NODE *t) {
+                if (ranked) t->set_size(size(t->left) + size(t->right) + 1);
+            }
+
+            //从t到根的路径上,子树大小都加上d
+            static void add_path(NODE *t, int d) {
+                if (!ranked) return;
+                for (; t; t = t->fa) t->set_size(t->get_size() + d);
+            }
+
+            //在alloc申请的内存上构造节点
+            template<class... Args>
+            NODE *create(Args &&...args) {
+                NODE *t = node_traits::allocate(alloc, 1);
+                try {
+                    new(t) NODE(std::forward<Args>(args)...);
+                } catch (...) {
+                    node_traits::deallocate(alloc, t, 1);
+                    throw;
+                }
+                return t;
+            }
+
+            //析构节点中的value_type再释放节点
+            void destroy(NODE *t) {
+                t->data()->~value_type();
+                t->~NODE();
+                node_traits::deallocate(alloc, t, 1);
+            }
+
+            //只析构数据,不归还节点
+            void destroy_values(NODE *t) {
+                if (t == nullptr) return;
+                destroy_values(t->left);
+                destroy_values(t->right);
+                t->data()->~value_type();
+            }
+
+            //清空整棵树,分配器能整块释放时就不逐个归还节点
+            void clear() {
+                if (root && is_slab_allocator<node_allocator>::value) {
+                    if (!std::is_trivially_destructible<value_type>::value) destroy_values(root);
+                    release_all(alloc);
+                } else {
+                    make_empty(root);
+                }
+                root = nullptr;
+                len = 0;
+                head = rear = nullptr;
+                end_node->set_prev(end_node);
+                end_node->set_next(end_node);
             }
 
-            void clone(NODE *&t, const NODE *p) {
-                if (p == nullptr) return;
-                t = new NODE(*p); //颜色也要复制
-                clone(t->left, p->left);
-                clone(t->right, p->right);
-                //和二叉链表的区别：要修改父节点
-                if (t->left) t->left->fa = t;
+            //复制other的形状和颜色
+            void clone(const RedBlackTree &other) {
+                root = copy_tree(other.root, other.len);
+                len = other.len;
+                head = front();
+                rear = back();
+                relink();
+            }
+
+            //复制以p为根的n个节点,节点按先序一次性从连续的内存中申请
+            //不用递归:每个节点复制好之后先走左儿子,右儿子压栈,栈深不超过树高
+            NODE *copy_tree(const NODE *p, int n) {
+                if (p == nullptr) return nullptr;
+                reserve_nodes(alloc, n);
+                const NODE *src[128];
+                NODE *dst[128];
+                int top = 0;
+                NODE *t = create(*p); //颜色也要复制
+                src[top] = p;
+                dst[top++] = t;
+                try {
+                    clone_nodes(src, dst, top);
+                } catch (...) {
+                    make_empty(t);
+                    throw;
+                }
+                return t;
+            }
+
+            void clone_nodes(const NODE **src, NODE **dst, int top) {
+                while (top) {
+                    const NODE *p = src[--top];
+                    NODE *t = dst[top];
+                    while (true) {
+                        if (p->right) {
+                            t->right = create(*p->right);
+                            t->right->fa = t;
+                            src[top] = p->right;
+                            dst[top++] = t->right;
+                        }
+                        if (p->left == nullptr) break;
+                        t->left = create(*p->left);
+                        t->left->fa = t;
+                        p = p->left;
+                        t = t->left;
+                    }
+                }
+            }
+
+            /**
+             * build the tree from n values in [first, ...) in O(n).
+             * the tree is perfectly balanced: the sizes of two sibling subtrees
+             * differ by at most one, so all levels but the deepest are full.
+             * the deepest level is red when it is not full and the rest black,
+             * then every path has the same number of black nodes.
+             * throw runtime_error (and build nothing) if the keys are not
+             * strictly increasing.
+             */
+            template<class Iter>
+            void build_sorted(Iter first, size_t n) {
+                clear();
+                if (n == 0) return;
+                reserve_nodes(alloc, n);
+                int full = 0; //满的层数
+                while (((size_t) 2 << full) - 1 <= n) full++;
+                int red_depth = ((size_t) 1 << full) - 1 == n ? -1 : full;
+                NODE *last = nullptr;
+                root = build(first, n, 0, red_depth, last);
+                len = (int) n;
+                head = front();
+                rear = back();
+                relink();
+            }
+
+            //按中序依次读入n个值,失败时把已经建好的部分删掉
+            template<class Iter>
+            NODE *build(Iter &first, size_t n, int depth, int red_depth, NODE *&last) {
+                if (n == 0) return nullptr;
+                NODE *l = build(first, (n - 1) / 2, depth + 1, red_depth, last), *t;
+                try {
+                    t = create(*first, depth == red_depth ? RED : BLACK);
+                } catch (...) {
+                    make_empty(l);
+                    throw;
+                }
+                ++first;
+                t->left = l;
+                if (l) l->fa = t;
+                try {
+                    if (last && !Compare()(last->data()->first, t->data()->first)) throw runtime_error();
+                    last = t;
+                    t->right = build(first, n - 1 - (n - 1) / 2, depth + 1, red_depth, last);
+                } catch (...) {
+                    make_empty(t);
+                    throw;
+                }
                 if (t->right) t->right->fa = t;
+                update(t);
+                return t;
             }
 
             //没有删除end_node和len
@@ -121,7 +650,7 @@ namespace sjtu {
                 //std::cout << t->left << std::endl;
                 make_empty(t->left);
                 make_empty(t->right);
-                delete t;
+                destroy(t);
                 t = nullptr;
             }
 
@@ -143,26 +672,113 @@ namespace sjtu {
                 return t;
             }
 
-            NODE *find(const Key &x) const {
-//                if (root == nullptr) return nullptr;
-//                if (equal(root->data->first, x)) return root;
+            //第一个不小于x的节点,没有就返回end_node
+            template<class K>
+            NODE *lower_bound(const K &x) const {
+                NODE *t = root, *res = end_node;
+                while (t) {
+                    if (Compare()(t->data()->first, x)) {
+                        t = t->right;
+                    } else {
+                        res = t;
+                        t = t->left;
+                    }
+                }
+                return res;
+            }
+
+            //第一个大于x的节点,没有就返回end_node
+            template<class K>
+            NODE *upper_bound(const K &x) const {
+                NODE *t = root, *res = end_node;
+                while (t) {
+                    if (Compare()(x, t->data()->first)) {
+                        res = t;
+                        t = t->left;
+                    } else {
+                        t = t->right;
+                    }
+                }
+                return res;
+            }
+
+            //比x小的key的个数,每层比较一次
+            size_t rank(const Key &x) const {
+                size_t r = 0;
                 NODE *t = root;
-                while (t && !equal(t->data->first, x)) {
-                    t = (Compare()(x, t->data->first)) ? t->left : t->right;
+                while (t) {
+                    if (Compare()(t->data()->first, x)) {
+                        r += size(t->left) + 1;
+                        t = t->right;
+                    } else {
+                        t = t->left;
+                    }
                 }
+                return r;
+            }
 
-                return t;
+            //第k小的节点(从0开始),不存在就返回空
+            NODE *select(size_t k) const {
+                NODE *t = root;
+                while (t) {
+                    size_t l = size(t->left);
+                    if (k == l) return t;
+                    if (k < l) {
+                        t = t->left;
+                    } else {
+                        k -= l + 1;
+                        t = t->right;
+                    }
+                }
+                return nullptr;
             }
 
-            void insert(const value_type &x) {
+            //t前面有多少个节点,end_node排在所有节点之后
+            size_t index_of(const NODE *t) const {
+                if (t == end_node) return len;
+                size_t r = size(t->left);
+                for (; t->fa; t = t->fa)
+                    if (t == t->fa->right) r += size(t->fa->left) + 1;
+                return r;
+            }
+
+            //每层只比较一次:记下最后一个不小于x的节点,走到底再判断一次它是不是x
+            //查找时x可以是Key以外的类型(比较器是透明的时候)
+            template<class K>
+            NODE *find(const K &x) const {
+                NODE *t = root, *cand = nullptr;
+                while (t) {
+                    if (Compare()(t->data()->first, x)) {
+                        t = t->right;
+                    } else {
+                        cand = t;
+                        t = t->left;
+                    }
+                }
+                if (cand && !Compare()(x, cand->data()->first)) return cand;
+                return nullptr;
+            }
+
+            //一次自上向下完成查找和插入
+            //返回新节点,或者和x的key相同的已有节点(second为false)
+            pair<NODE *, bool> insert(const value_type &x) {
+                return insert(x.first, [this, &x](NODE *fa) { return create(x, RED, fa); });
+            }
+
+            //make(fa)给出挂在fa下面的红色新节点,key已经存在时不会调用
+            template<class Make>
+            pair<NODE *, bool> insert(const Key &k, Make make) {
                 if (root == nullptr) {
-                    root = new NODE(x, BLACK); //根节点为黑色
+                    root = make(nullptr);
+                    root->color = BLACK; //根节点为黑色
                     head = rear = root;
+                    link_after(end_node, root);
                     len++;
-                    return;
+                    return pair<NODE *, bool>(root, true);
                 }
-                NODE *t, *parent, *GrandP;
+                NODE *t, *parent, *GrandP, *cand = nullptr;
                 t = parent = GrandP = root;
+                bool go_left = false;
                 while (1) {
                     //在路径中,自上向下访问
                     if (t) {
@@ -173,31 +789,113 @@ namespace sjtu {
                             t->color = RED;
                             insert_adjust(GrandP, parent, t); //消除连续红节点
                         }
+                        //每层只比较一次,最后一次向右走的节点是不大于k的最大的key
+                        go_left = Compare()(k, t->data()->first);
+                        if (!go_left) cand = t;
                         GrandP = parent;
                         parent = t;
-                        t = (Compare()(x.first, t->data->first)) ? t->left : t->right;
+                        t = go_left ? t->left : t->right;
                     } else {
+                        if (cand && !Compare()(cand->data()->first, k)) {
+                            //key已经存在,路上的变色和旋转不影响红黑树的性质
+                            root->color = BLACK;
+                            return pair<NODE *, bool>(cand, false);
+                        }
                         //遍历到了叶子节点，就新加入节点
-                        t = new NODE(x, RED, parent);
+                        t = make(parent);
                         len++;
-                        if (Compare()(x.first, parent->data->first)) parent->left = t;
+                        if (go_left) parent->left = t;
                         else parent->right = t;
+                        link_after(go_left ? parent->get_prev() : parent, t);
+                        //挂在最小值左边的是新的最小值,挂在最大值右边的是新的最大值
+                        if (go_left && parent == head) head = t;
+                        if (!go_left && parent == rear) rear = t;
+                        add_path(parent, 1); //先更新大小,之后的旋转才能算对
                         insert_adjust(GrandP, parent, t);
                         root->color = BLACK;
-                        head = front(); rear = back();
-                        return;
+                        return pair<NODE *, bool>(t, true);
                     }
                 }
             }
 
-            void remove(const Key &del) {
+            /**
+             * where a node with key k goes if it is placed right before hint:
+             * the left child of hint when that is empty, otherwise the right
+             * child of the previous node (which has none).
+             * return nullptr if hint is wrong; dup is set when k is the key of
+             * hint or of the node before it. the tree is not empty.
+             */
+            NODE *hint_parent(NODE *hint, const Key &k, bool &go_left, NODE *&dup) const {
+                dup = nullptr;
+                NODE *before = hint == end_node ? rear : hint == head ? nullptr : prev(hint);
+                if (hint != end_node && !Compare()(k, hint->data()->first)) {
+                    if (!Compare()(hint->data()->first, k)) dup = hint;
+                    return nullptr;
+                }
+                if (before && !Compare()(before->data()->first, k)) {
+                    if (!Compare()(k, before->data()->first)) dup = before;
+                    return nullptr;
+                }
+                go_left = hint != end_node && hint->left == nullptr;
+                return go_left ? hint : before;
+            }
+
+            //把新节点t直接挂在parent下面,再自下向上调整,均摊O(1)
+            void attach(NODE *parent, bool go_left, NODE *t) {
+                t->fa = parent;
+                t->color = RED;
+                if (go_left) parent->left = t;
+                else parent->right = t;
+                link_after(go_left ? parent->get_prev() : parent, t);
+                add_path(parent, 1);
+                len++;
+                if (go_left && parent == head) head = t;
+                if (!go_left && parent == rear) rear = t;
+                insert_fixup(t);
+            }
+
+            //红色的x刚挂上去,自下向上消除红红相连;变色最多一直传到根,旋转最多两次
+            void insert_fixup(NODE *x) {
+                while (x != root && x->fa->color == RED) {
+                    NODE *p = x->fa, *g = p->fa; //p是红的,不会是根
+                    NODE *u = p == g->left ? g->right : g->left;
+                    if (u && u->color == RED) {
+                        p->color = u->color = BLACK;
+                        g->color = RED;
+                        x = g;
+                        continue;
+                    }
+                    if (p == g->left) {
+                        if (x == p->right) {
+                            rotate_left(p);
+                            p = x;
+                        }
+                        rotate_right(g);
+                    } else {
+                        if (x == p->left) {
+                            rotate_right(p);
+                            p = x;
+                        }
+                        rotate_left(g);
+                    }
+                    p->color = BLACK;
+                    g->color = RED;
+                    if (g == root) root = p;
+                    break;
+                }
+                root->color = BLACK;
+            }
+
+            //删除树中的节点x,一路上用指针判断是否到了x,每层只比较一次key
+            void remove(NODE *x) {
                 //即最后用替身rep来代替原本t的位置，然后删除t
                 NODE *t, *parent, *t2; //t2是t的兄弟节点
+                const Key &del = x->data()->first;
 
-                if (root == nullptr) return;
-                if (equal(root->data->first, del) && root->left == nullptr && root->right == nullptr) {
+                if (x == root && root->left == nullptr && root->right == nullptr) {
                     len--;
-                    delete root;
+                    unlink(root);
+                    destroy(root);
                     root = nullptr;
                     head = rear = nullptr;
                     return;
@@ -205,9 +903,9 @@ namespace sjtu {
 
                 t = parent = t2 = root;
                 while (1) {
-                    remove_adjust(parent, t, t2, del);
+                    remove_adjust(parent, t, t2, x);
                     //删除节点在中间，就把它变成叶节点/非满节点
-                    if (equal(t->data->first, del) && t->left && t->right) {
+                    if (t == x && t->left && t->right) {
                         NODE *rep = t->right;
                         //删除点的替身rep为t的右子树的最小值
                         while (rep->left) rep = rep->left;
@@ -215,6 +913,10 @@ namespace sjtu {
                         COLOR rep_color = rep->color;
                         rep->color = t->color;
                         t->color = rep_color;
+                        //两个节点交换位置,子树大小跟着位置走
+                        size_t rep_size = rep->get_size();
+                        rep->set_size(t->get_size());
+                        t->set_size(rep_size);
                         //先改父亲
                         NODE *t_fa = t->fa, *rep_fa = rep->fa;;
                         if (t_fa) {
@@ -256,19 +958,27 @@ namespace sjtu {
                         continue;
                     }
                     //在叶节点/非满节点,t2 = nullptr
-                    if (equal(t->data->first, del)) {
+                    if (t == x) {
+                        add_path(t->fa, -1);
                         if (parent->left == t) parent->left = t->right;
                         else parent->right = t->right;
+                        if (t->right) t->right->fa = parent;
                         len--;
-                        delete t;
+                        unlink(t);
+                        destroy(t);
                         t = nullptr;
                         root->color = BLACK;
-                        head = front(); rear = back();
+                        if (threaded) {
+                            head = end_node->get_next();
+                            rear = end_node->get_prev();
+                        } else {
+                            head = front(); rear = back();
+                        }
                         return;
                     }
 
                     parent = t;
-                    t = (Compare()(del, t->data->first)) ? t->left : t->right;
+                    t = (Compare()(del, t->data()->first)) ? t->left : t->right;
                     t2 = (t == parent->left) ? parent->right : parent->left;
                 }
             }
@@ -291,7 +1001,8 @@ namespace sjtu {
             }
 
             //t使当前节点,t2是t的兄弟
-            void remove_adjust(NODE *&p, NODE *&t, NODE *&t2, const Key &del) {
+            void remove_adjust(NODE *&p, NODE *&t, NODE *&t2, NODE *x) {
+                const Key &del = x->data()->first;
 //                if (t == nullptr || t2 == nullptr || p == nullptr) return;
                 if (t->color == RED) return;
                 if (t == root) {
@@ -338,7 +1049,7 @@ namespace sjtu {
                         }
                     }
                 } else {//第二种,t有红儿子
-                    if (equal(t->data->first, del)) { //2.1: 找到被删节点 t
+                    if (t == x) { //2.1: 找到被删节点 t
                         if (t->left && t->right) { //2.1.1: t有两个儿子
                             if (t->right->color == BLACK) {
                                 LL(t);
@@ -365,7 +1076,7 @@ namespace sjtu {
                     } else { //2.2: t不是被删节点
                         //向下走一层
                         p = t;
-                        t = (Compare()(del, p->data->first)) ? p->left : p->right;
+                        t = (Compare()(del, p->data()->first)) ? p->left : p->right;
                         t2 = (t == p->left) ? p->right : p->left;
                         if (t->color == BLACK) { //2.2.1: 新节点t为黑色
                             if (t2 == p->right) {//2.2.1.1: 新节点t是p的左儿子
@@ -382,7 +1093,7 @@ namespace sjtu {
                             t = p;
                             p = t2;
                             t2 = (t == p->left) ? p->right : p->left;
-                            remove_adjust(p, t, t2, del);
+                            remove_adjust(p, t, t2, x);
                         }
                     }
                 }
@@ -401,6 +1112,8 @@ namespace sjtu {
 
                 p->right = gp;
                 gp->fa = p;
+                update(gp);
+                update(p);
 
                 gp->color = RED;
                 p->color = BLACK;
@@ -421,6 +1134,8 @@ namespace sjtu {
 
                 p->left = gp;
                 gp->fa = p;
+                update(gp);
+                update(p);
 
                 gp->color = RED;
                 p->color = BLACK;
@@ -445,6 +1160,9 @@ namespace sjtu {
                 p->fa = t;
                 t->right = gp;
                 gp->fa = t;
+                update(gp);
+                update(p);
+                update(t);
 
                 gp->color = RED;
                 t->color = BLACK;
@@ -469,11 +1187,397 @@ namespace sjtu {
                 p->fa = t;
                 t->left = gp;
                 gp->fa = t;
+                update(gp);
+                update(p);
+                update(t);
 
                 gp->color = RED;
                 t->color = BLACK;
                 while (root->fa) root = root->fa;
             }
+
+            /*
+             * join/split: 把树看成(左边, 中间的节点, 右边)三部分
+             * h表示黑高:从子树的根到空节点路径上黑节点的个数(包括根),
+             * 两个函数都沿着调用链把黑高传下去,不用再从根往下数
+             * 拆出来的子树的根可能是红色的,join时先涂黑
+             */
+
+            static int black_height(const NODE *t) {
+                int h = 0;
+                for (; t; t = t->left) h += t->color == BLACK;
+                return h;
+            }
+
+            static void set_left(NODE *t, NODE *c) {
+                t->left = c;
+                if (c) c->fa = t;
+            }
+
+            static void set_right(NODE *t, NODE *c) {
+                t->right = c;
+                if (c) c->fa = t;
+            }
+
+            //x的右儿子转上来,只改这三层的指针,不管this->root
+            static void rotate_left(NODE *x) {
+                NODE *y = x->right, *p = x->fa;
+                set_right(x, y->left);
+                set_left(y, x);
+                y->fa = p;
+                if (p) (p->left == x ? p->left : p->right) = y;
+                update(x);
+                update(y);
+            }
+
+            static void rotate_right(NODE *x) {
+                NODE *y = x->left, *p = x->fa;
+                set_left(x, y->right);
+                set_right(y, x);
+                y->fa = p;
+                if (p) (p->left == x ? p->left : p->right) = y;
+                update(x);
+                update(y);
+            }
+
+            //红色的x刚挂上去,自下向上消除红红相连,返回整棵树的根
+            //根被涂红时改回黑色,黑高h加一
+            static NODE *fix_red(NODE *x, int &h) {
+                while (x->fa && x->fa->color == RED) {
+                    NODE *p = x->fa, *g = p->fa; //p是红的,不会是根
+                    NODE *u = p == g->left ? g->right : g->left;
+                    if (u && u->color == RED) {
+                        p->color = u->color = BLACK;
+                        g->color = RED;
+                        x = g;
+                        continue;
+                    }
+                    if (p == g->left) {
+                        if (x == p->right) {
+                            rotate_left(p);
+                            p = x;
+                        }
+                        rotate_right(g);
+                    } else {
+                        if (x == p->left) {
+                            rotate_right(p);
+                            p = x;
+                        }
+                        rotate_left(g);
+                    }
+                    p->color = BLACK;
+                    g->color = RED;
+                    break;
+                }
+                while (x->fa) x = x->fa;
+                if (x->color == RED) {
+                    x->color = BLACK;
+                    h++;
+                }
+                return x;
+            }
+
+            /**
+             * join l, k and r into one tree, all keys of l < k < all keys of r.
+             * k is hung at the spine of the higher tree where the black heights
+             * match, then fixed bottom-up: O(|hl - hr| + 1).
+             * h is set to the black height of the result.
+             */
+            static NODE *join(NODE *l, int hl, NODE *k, NODE *r, int hr, int &h) {
+                if (l && l->color == RED) {
+                    l->color = BLACK;
+                    hl++;
+                }
+                if (r && r->color == RED) {
+                    r->color = BLACK;
+                    hr++;
+                }
+                k->fa = nullptr;
+                if (hl == hr) {
+                    k->color = BLACK;
+                    set_left(k, l);
+                    set_right(k, r);
+                    update(k);
+                    h = hl + 1;
+                    return k;
+                }
+                k->color = RED;
+                NODE *p = nullptr;
+                if (hl > hr) {
+                    //沿l的右链往下,找黑高等于hr的黑节点c,k替换c的位置
+                    NODE *c = l;
+                    for (int ch = hl; c && (c->color == RED || ch > hr); c = c->right) {
+                        ch -= c->color == BLACK;
+                        p = c;
+                    }
+                    set_left(k, c);
+                    set_right(k, r);
+                    set_right(p, k);
+                    add_path(p, (int) size(r) + 1);
+                    h = hl;
+                } else {
+                    NODE *c = r;
+                    for (int ch = hr; c && (c->color == RED || ch > hl); c = c->left) {
+                        ch -= c->color == BLACK;
+                        p = c;
+                    }
+                    set_right(k, c);
+                    set_left(k, l);
+                    set_left(p, k);
+                    add_path(p, (int) size(l) + 1);
+                    h = hr;
+                }
+                update(k);
+                return fix_red(k, h);
+            }
+
+            //没有中间节点时,从l中拆出最大的节点当作k
+            NODE *join2(NODE *l, int hl, NODE *r, int hr, int &h) const {
+                if (l == nullptr) {
+                    h = hr;
+                    return r;
+                }
+                if (r == nullptr) {
+                    h = hl;
+                    return l;
+                }
+                NODE *m = l;
+                while (m->right) m = m->right;
+                NODE *f, *rest;
+                int hrest;
+                split(l, hl, m->data()->first, l, hl, f, rest, hrest);
+                return join(l, hl, m, r, hr, h);
+            }
+
+            /**
+             * split the tree t (black height h) by key: l gets the keys less
+             * than key, r the greater ones, f the node equal to key (or nullptr).
+             * O(log n): the joins on the way back up cost O(h) in total.
+             */
+            void split(NODE *t, int h, const Key &key, NODE *&l, int &hl, NODE *&f, NODE *&r, int &hr) const {
+                if (t == nullptr) {
+                    l = f = r = nullptr;
+                    hl = hr = 0;
+                    return;
+                }
+                NODE *tl = t->left, *tr = t->right;
+                int ch = h - (t->color == BLACK);
+                if (tl) tl->fa = nullptr;
+                if (tr) tr->fa = nullptr;
+                t->left = t->right = t->fa = nullptr;
+                update(t);
+                if (Compare()(key, t->data()->first)) {
+                    split(tl, ch, key, l, hl, f, r, hr);
+                    r = join(r, hr, t, tr, ch, hr);
+                } else if (Compare()(t->data()->first, key)) {
+                    split(tr, ch, key, l, hl, f, r, hr);
+                    l = join(tl, ch, t, l, hl, hl);
+                } else {
+                    f = t;
+                    l = tl;
+                    r = tr;
+                    hl = hr = ch;
+                }
+            }
+
+            //被丢掉的子树先用fa串起来,所有线程结束后再统一释放
+            struct trash_list {
+                NODE *head, *tail;
+
+                trash_list() : head(nullptr), tail(nullptr) {}
+
+                void push(NODE *t) {
+                    t->fa = nullptr;
+                    if (tail) tail->fa = t;
+                    else head = t;
+                    tail = t;
+                }
+
+                void append(trash_list &other) {
+                    if (other.head == nullptr) return;
+                    if (tail) tail->fa = other.head;
+                    else head = other.head;
+                    tail = other.tail;
+                }
+            };
+
+            //释放垃圾链表上的所有子树,返回节点个数
+            //linked: 节点还串在这棵树的线索上,要先摘下来
+            int destroy_trash(trash_list &bin, bool linked) {
+                int cnt = 0;
+                for (NODE *t = bin.head, *next; t; t = next) {
+                    next = t->fa;
+                    cnt += destroy_subtree(t, linked);
+                }
+                bin.head = bin.tail = nullptr;
+                return cnt;
+            }
+
+            int destroy_subtree(NODE *t, bool linked) {
+                if (t == nullptr) return 0;
+                int cnt = destroy_subtree(t->left, linked) + destroy_subtree(t->right, linked) + 1;
+                if (linked) unlink(t);
+                destroy(t);
+                return cnt;
+            }
+
+            //黑高不小于这个值的子树至少有2^FORK_HEIGHT-1个节点,才值得开线程
+            enum { FORK_HEIGHT = 12 };
+
+            //最多分叉的层数,叶子上的任务数大约是线程数的两倍
+            static int fork_depth() {
+                int threads = std::thread::hardware_concurrency(), d = 0;
+                if (threads < 2) return 0;
+                while ((1 << d) < threads) d++;
+                return d + 1;
+            }
+
+            //左右两个互不相交的子问题:够大时左边交给新线程,自己做右边
+            //开线程失败就按顺序做
+            template<class Left, class Right>
+            static void fork(bool parallel, trash_list &bin, Left left, Right right) {
+                if (parallel) {
+                    trash_list other;
+                    std::thread th;
+                    try {
+                        th = std::thread([&left, &other] { left(other); });
+                    } catch (...) {
+                        parallel = false;
+                    }
+                    if (parallel) {
+                        right(bin);
+                        th.join();
+                        bin.append(other);
+                        return;
+                    }
+                }
+                left(bin);
+                right(bin);
+            }
+
+            /*
+             * 集合运算: a是这棵树的节点, b是另一棵树
+             * 用b的根把a拆成两半,左右两边分别递归(可以并行),再用join接起来
+             * 合并m个和n个节点(m <= n)一共 O(m log(n/m + 1))
+             * 递归过程中不申请也不释放节点,分配器不需要线程安全
+             */
+
+            //b也是这棵树的节点(复制过来的),key相同时保留a的节点,b的放进bin
+            NODE *unite(NODE *a, int ha, NODE *b, int hb, int &h, trash_list &bin, int forks) const {
+                if (a == nullptr) {
+                    h = hb;
+                    return b;
+                }
+                if (b == nullptr) {
+                    h = ha;
+                    return a;
+                }
+                NODE *bl = b->left, *br = b->right;
+                int ch = hb - (b->color == BLACK);
+                if (bl) bl->fa = nullptr;
+                if (br) br->fa = nullptr;
+                b->left = b->right = nullptr;
+                NODE *l, *f, *r, *L, *R;
+                int hl, hr, hL, hR;
+                split(a, ha, b->data()->first, l, hl, f, r, hr);
+                if (f) {
+                    b->set_prev(b); //标记为丢掉了,见unite_with
+                    bin.push(b);
+                    b = f;
+                }
+                fork(forks > 0 && ch >= FORK_HEIGHT, bin,
+                     [&](trash_list &t) { L = unite(l, hl, bl, ch, hL, t, forks - 1); },
+                     [&](trash_list &t) { R = unite(r, hr, br, ch, hR, t, forks - 1); });
+                return join(L, hL, b, R, hR, h);
+            }
+
+            //只保留key在b中出现的节点
+            NODE *intersect(NODE *a, int ha, const NODE *b, int hb, int &h, trash_list &bin, int forks) const {
+                if (a == nullptr || b == nullptr) {
+                    if (a) bin.push(a);
+                    h = 0;
+                    return nullptr;
+                }
+                int ch = hb - (b->color == BLACK);
+                NODE *l, *f, *r, *L, *R;
+                int hl, hr, hL, hR;
+                split(a, ha, b->data()->first, l, hl, f, r, hr);
+                fork(forks > 0 && ch >= FORK_HEIGHT, bin,
+                     [&](trash_list &t) { L = intersect(l, hl, b->left, ch, hL, t, forks - 1); },
+                     [&](trash_list &t) { R = intersect(r, hr, b->right, ch, hR, t, forks - 1); });
+                if (f) return join(L, hL, f, R, hR, h);
+                return join2(L, hL, R, hR, h);
+            }
+
+            //删掉key在b中出现的节点
+            NODE *subtract(NODE *a, int ha, const NODE *b, int hb, int &h, trash_list &bin, int forks) const {
+                if (a == nullptr || b == nullptr) {
+                    h = ha;
+                    return a;
+                }
+                int ch = hb - (b->color == BLACK);
+                NODE *l, *f, *r, *L, *R;
+                int hl, hr, hL, hR;
+                split(a, ha, b->data()->first, l, hl, f, r, hr);
+                if (f) bin.push(f);
+                fork(forks > 0 && ch >= FORK_HEIGHT, bin,
+                     [&](trash_list &t) { L = subtract(l, hl, b->left, ch, hL, t, forks - 1); },
+                     [&](trash_list &t) { R = subtract(r, hr, b->right, ch, hR, t, forks - 1); });
+                return join2(L, hL, R, hR, h);
+            }
+
+            //other的节点先按原样复制到这棵树的分配器里,再合并
+            void unite_with(const RedBlackTree &other) {
+                if (this == &other || other.root == nullptr) return;
+                NODE *b = copy_tree(other.root, other.len), *first = nullptr;
+                if (threaded) {
+                    //复制出的节点先按顺序单独串起来,合并之后再逐个接进来
+                    NODE *last = nullptr;
+                    for (NODE *t = b; t; t = t->left) first = t;
+                    for (NODE *t = first; t; t = tree_next(t)) {
+                        t->set_prev(last);
+                        if (last) last->set_next(t);
+                        last = t;
+                    }
+                }
+                trash_list bin;
+                int h;
+                root = unite(root, black_height(root), b, black_height(b), h, bin, fork_depth());
+                //留下来的新节点按从小到大的顺序接在树上的前驱后面,前驱已经在链表里了
+                for (NODE *t = first, *next; t; t = next) {
+                    next = t->get_next();
+                    if (t->get_prev() == t) continue;
+                    NODE *p = tree_prev(t);
+                    link_after(p ? p : end_node, t);
+                }
+                len += other.len - destroy_trash(bin, false);
+                head = front();
+                rear = back();
+            }
+
+            void intersect_with(const RedBlackTree &other) {
+                if (this == &other || root == nullptr) return;
+                trash_list bin;
+                int h;
+                root = intersect(root, black_height(root), other.root, black_height(other.root), h, bin, fork_depth());
+                len -= destroy_trash(bin, true);
+                head = front();
+                rear = back();
+            }
+
+            void subtract_with(const RedBlackTree &other) {
+                if (this == &other) {
+                    clear();
+                    return;
+                }
+                if (root == nullptr || other.root == nullptr) return;
+                trash_list bin;
+                int h;
+                root = subtract(root, black_height(root), other.root, black_height(other.root), h, bin, fork_depth());
+                len -= destroy_trash(bin, true);
+                head = front();
+                rear = back();
+            }
         };
 
         /**
@@ -497,7 +1601,7 @@ namespace sjtu {
 
         private:
             NODE *p;
-            const map<Key, T, Compare> *id;
+            const map *id;
         public:
             // The following code is written for the C++ type_traits library.
             // Type traits is a C++ feature for describing certain properties of a type.
@@ -522,7 +1626,7 @@ namespace sjtu {
 
             iterator() : p(nullptr), id(nullptr) {}
 
-            iterator(NODE *_p, const map<Key, T, Compare> *_id) : p(_p), id(_id) {}
+            iterator(NODE *_p, const map *_id) : p(_p), id(_id) {}
 
             iterator(const iterator &other) : p(other.p), id(other.id) {}
 
@@ -536,14 +1640,7 @@ namespace sjtu {
             //TODO ++iter
             iterator &operator++() {
                 if (p == id->mp.end_node || p == nullptr) throw invalid_iterator();
-                if (p == id->mp.rear) p = id->mp.end_node;
-                else if (p->right) {
-                    p = p->right;
-                    while (p->left) p = p->left;
-                } else {
-                    while (p->fa && p->fa->right == p) p = p->fa;
-                    p = p->fa;
-                }
+                p = id->mp.next(p);
                 return *this;
             }
 
@@ -556,21 +1653,24 @@ namespace sjtu {
             iterator &operator--() {
                 if (id->mp.root == nullptr) throw invalid_iterator(); //判断map空
                 if (p == id->mp.head || p == nullptr) throw invalid_iterator();
-                if (p == id->mp.end_node) p = id->mp.back();
-                else if (p->left) {
-                    p = p->left;
-                    while (p->right) p = p->right;
-                } else {
-                    while (p->fa && p->fa->left == p) p = p->fa;
-                    p = p->fa;
-                }
+                p = id->mp.prev(p);
                 return *this;
             }
 
             //返回的是 value_type，不是指针
             value_type &operator*() const {
                 if (p == id->mp.end_node || p == nullptr) throw invalid_iterator();
-                return *(p->data);
+                return *(p->data());
+            }
+
+            /**
+             * the number of increments from rhs to this, in O(log n).
+             * only with order_statistics; throw invalid_iterator for iterators of different maps.
+             */
+            std::ptrdiff_t operator-(const iterator &rhs) const {
+                static_assert(ranked, "iterator difference needs order_statistics");
+                if (id == nullptr || id != rhs.id) throw invalid_iterator();
+                return (std::ptrdiff_t) id->mp.index_of(p) - (std::ptrdiff_t) id->mp.index_of(rhs.p);
             }
 
             bool operator==(const iterator &rhs) const {
@@ -599,7 +1699,7 @@ namespace sjtu {
 
             noexcept {
                 if (p == id->mp.end_node || p == nullptr) throw invalid_iterator();
-                return p->data;
+                return p->data();
             }
         };
 
@@ -610,7 +1710,7 @@ namespace sjtu {
 
         private:
             NODE *p;
-            const map<Key, T, Compare> *id;
+            const map *id;
 
         public:
             const_iterator() : p(nullptr), id(nullptr) {}
@@ -619,7 +1719,7 @@ namespace sjtu {
 
             const_iterator(const iterator &other) : p(other.p), id(other.id) {}
 
-            const_iterator(NODE *_p, const map<Key, T, Compare> *_id) : p(_p), id(_id) {}
+            const_iterator(NODE *_p, const map *_id) : p(_p), id(_id) {}
 
             const_iterator operator++(int) {
                 const_iterator t(*this);
@@ -629,14 +1729,7 @@ namespace sjtu {
 
             const_iterator &operator++() {
                 if (p == id->mp.end_node || p == nullptr) throw invalid_iterator();
-                if (p == id->mp.rear) p = id->mp.end_node;
-                else if (p->right) {
-                    p = p->right;
-                    while (p->left) p = p->left;
-                } else {
-                    while (p->fa && p->fa->right == p) p = p->fa;
-                    p = p->fa;
-                }
+                p = id->mp.next(p);
                 return *this;
             }
 
@@ -649,20 +1742,23 @@ namespace sjtu {
             const_iterator &operator--() {
                 if (id->mp.root == nullptr) throw invalid_iterator(); //判断map空
                 if (p == id->mp.head || p == nullptr) throw invalid_iterator();
-                if (p == id->mp.end_node) p = id->mp.back();
-                else if (p->left) {
-                    p = p->left;
-                    while (p->right) p = p->right;
-                } else {
-                    while (p->fa && p->fa->left == p) p = p->fa;
-                    p = p->fa;
-                }
+                p = id->mp.prev(p);
                 return *this;
             }
 
             value_type &operator*() const {
                 if (p == id->mp.end_node || p == nullptr) throw invalid_iterator();
-                return *(p->data);
+                return *(p->data());
+            }
+
+            /**
+             * the number of increments from rhs to this, in O(log n).
+             * only with order_statistics; throw invalid_iterator for iterators of different maps.
+             */
+            std::ptrdiff_t operator-(const const_iterator &rhs) const {
+                static_assert(ranked, "iterator difference needs order_statistics");
+                if (id == nullptr || id != rhs.id) throw invalid_iterator();
+                return (std::ptrdiff_t) id->mp.index_of(p) - (std::ptrdiff_t) id->mp.index_of(rhs.p);
             }
 
             bool operator==(const iterator &rhs) const {
@@ -689,10 +1785,38 @@ namespace sjtu {
              */
             value_type *operator->() const noexcept {
                 if (p == id->mp.end_node || p == nullptr) throw invalid_iterator();
-                return p->data;
+                return p->data();
+            }
+        };
+
+
+        /**
+         * the elements with keys in [a, b), returned by map::range.
+         * begin() is found in O(log n) and walking k elements costs O(k) amortized.
+         */
+        template<class Iter>
+        class basic_range {
+        private:
+            Iter first, last;
+
+        public:
+            basic_range(const Iter &_first, const Iter &_last) : first(_first), last(_last) {}
+
+            Iter begin() const {
+                return first;
+            }
+
+            Iter end() const {
+                return last;
+            }
+
+            bool empty() const {
+                return first == last;
             }
         };
 
+        typedef basic_range<iterator> range_type;
+        typedef basic_range<const_iterator> const_range_type;
 
         //-------------------------------------------------------------------
 
@@ -705,6 +1829,60 @@ namespace sjtu {
             return *this;
         }
 
+        //移动之后other为空,指向other的迭代器全部失效
+        map(map &&other) : mp(std::move(other.mp)) {}
+
+        map &operator=(map &&other) {
+            mp = std::move(other.mp);
+            return *this;
+        }
+
+        /**
+         * build a map from [first, last), which must be sorted by Compare
+         * without equal keys, in O(n) instead of n inserts.
+         * the tree is perfectly balanced and, with the default allocator, its
+         * nodes are in one contiguous block.
+         * needs forward iterators (the length is counted first).
+         * throw runtime_error if the keys are not strictly increasing.
+         */
+        template<class Iter>
+        static map from_sorted(Iter first, Iter last) {
+            map res;
+            res.mp.build_sorted(first, (size_t) std::distance(first, last));
+            return res;
+        }
+
+        /*
+         * set operations by key, built on split/join of the red-black tree.
+         * with m elements in the smaller map and n in the larger one they do
+         * O(m log(n/m + 1)) work instead of m inserts or erases, and big
+         * subproblems run on separate threads (Compare must not throw).
+         * nodes of this map are relinked, not copied: iterators to elements
+         * that stay in this map remain valid.
+         */
+
+        /**
+         * add the elements of other whose keys are not in this map.
+         * for a key in both maps the value in this map is kept.
+         */
+        void union_with(const map &other) {
+            mp.unite_with(other.mp);
+        }
+
+        /**
+         * keep only the elements whose keys are also in other.
+         */
+        void intersect_with(const map &other) {
+            mp.intersect_with(other.mp);
+        }
+
+        /**
+         * remove the elements whose keys are in other.
+         */
+        void difference_with(const map &other) {
+            mp.subtract_with(other.mp);
+        }
+
         //会自动调用成员 RedBlackTree 的析构函数
         ~map() {}
 
@@ -717,13 +1895,13 @@ namespace sjtu {
         T &at(const Key &key) {
             NODE *tmp = mp.find(key);
             if (tmp == nullptr) throw index_out_of_bound();
-            return tmp->data->second;
+            return tmp->data()->second;
         }
 
         const T &at(const Key &key) const {
             NODE *tmp = mp.find(key);
             if (tmp == nullptr) throw index_out_of_bound();
-            return tmp->data->second;
+            return tmp->data()->second;
         }
 
         /**
@@ -733,11 +1911,10 @@ namespace sjtu {
          *   performing an insertion if such key does not already exist.
          */
         T &operator[](const Key &key) {
-            NODE *tmp = mp.find(key);
-            if (tmp)
-                return tmp->data->second;
-            else
-                return insert(value_type(key, T())).first.p->data->second;
+            //查找和插入在同一次自上向下的遍历中完成,key不存在时才构造T()
+            return mp.insert(key, [this, &key](NODE *fa) {
+                return mp.create(key, T(), RED, fa);
+            }).first->data()->second;
         }
 
         /**
@@ -746,7 +1923,7 @@ namespace sjtu {
         const T &operator[](const Key &key) const {
             NODE *tmp = mp.find(key);
             if (tmp == nullptr) throw index_out_of_bound();
-            return tmp->data->second;
+            return tmp->data()->second;
         }
 
         /**
@@ -793,9 +1970,7 @@ namespace sjtu {
          * clears the contents
          */
         void clear() {
-            mp.make_empty(mp.root);
-            mp.len = 0;
-            mp.head = mp.rear = nullptr;
+            mp.clear();
         }
 
         /**
@@ -805,12 +1980,55 @@ namespace sjtu {
          *   the second one is true if insert successfully, or false.
          */
         pair<iterator, bool> insert(const value_type &value) {
-            NODE *tmp = mp.find(value.first);
-            if (tmp) return pair<iterator, bool>(iterator(tmp, this), false);
+            pair<NODE *, bool> res = mp.insert(value);
+            return pair<iterator, bool>(iterator(res.first, this), res.second);
+        }
+
+        /**
+         * insert value, placing it right before hint if that keeps the order.
+         * with a correct hint (e.g. end() for increasing keys) the node is
+         * attached next to hint and fixed bottom-up in amortized O(1)
+         * (O(log n) with order_statistics); otherwise it is a normal insert.
+         * return the new element or the one with the same key.
+         * throw invalid_iterator if hint is not an iterator of this map.
+         */
+        iterator insert(const_iterator hint, const value_type &value) {
+            if (hint.id != this || hint.p == nullptr) throw invalid_iterator();
+            if (mp.root == nullptr) return iterator(mp.insert(value).first, this);
+            bool go_left;
+            NODE *dup, *parent = mp.hint_parent(hint.p, value.first, go_left, dup);
+            if (dup) return iterator(dup, this);
+            if (parent == nullptr) return iterator(mp.insert(value).first, this);
+            NODE *t = mp.create(value);
+            mp.attach(parent, go_left, t);
+            return iterator(t, this);
+        }
 
-            mp.insert(value);
-            tmp = mp.find(value.first);
-            return pair<iterator, bool>(iterator(tmp, this), true);
+        /**
+         * like insert(hint, value), but the value is constructed from args
+         * in its node first.
+         */
+        template<class... Args>
+        iterator emplace_hint(const_iterator hint, Args &&...args) {
+            if (hint.id != this || hint.p == nullptr) throw invalid_iterator();
+            NODE *t = mp.create(emplace_tag(), std::forward<Args>(args)...);
+            NODE *dup = nullptr, *parent = nullptr;
+            bool go_left;
+            if (mp.root) parent = mp.hint_parent(hint.p, t->data()->first, go_left, dup);
+            if (parent) {
+                mp.attach(parent, go_left, t);
+                return iterator(t, this);
+            }
+            if (dup == nullptr) {
+                pair<NODE *, bool> res = mp.insert(t->data()->first, [t](NODE *fa) {
+                    t->fa = fa;
+                    return t;
+                });
+                if (res.second) return iterator(t, this);
+                dup = res.first;
+            }
+            mp.destroy(t);
+            return iterator(dup, this);
         }
 
         /**
@@ -822,7 +2040,7 @@ namespace sjtu {
             if (pos == end() || pos.p == nullptr || pos.id != this)
                 throw invalid_iterator();
             else
-                mp.remove(pos.p->data->first);
+                mp.remove(pos.p);
         }
 
         /**
@@ -855,8 +2073,174 @@ namespace sjtu {
             else return const_iterator(t, this);
         }
 
+        /**
+         * the first element whose key is not less than key, or end().
+         */
+        iterator lower_bound(const Key &key) {
+            return iterator(mp.lower_bound(key), this);
+        }
+
+        const_iterator lower_bound(const Key &key) const {
+            return const_iterator(mp.lower_bound(key), this);
+        }
+
+        /**
+         * the first element whose key is greater than key, or end().
+         */
+        iterator upper_bound(const Key &key) {
+            return iterator(mp.upper_bound(key), this);
+        }
+
+        const_iterator upper_bound(const Key &key) const {
+            return const_iterator(mp.upper_bound(key), this);
+        }
+
+        /**
+         * [lower_bound(key), upper_bound(key)), holding at most one element.
+         */
+        pair<iterator, iterator> equal_range(const Key &key) {
+            iterator first = lower_bound(key);
+            //key存在时上界就是下一个,不存在时上下界相同,都不用再找一遍
+            if (first == end() || Compare()(key, first->first)) return pair<iterator, iterator>(first, first);
+            iterator last = first;
+            return pair<iterator, iterator>(first, ++last);
+        }
+
+        pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+            const_iterator first = lower_bound(key);
+            if (first == cend() || Compare()(key, first->first))
+                return pair<const_iterator, const_iterator>(first, first);
+            const_iterator last = first;
+            return pair<const_iterator, const_iterator>(first, ++last);
+        }
+
+        /*
+         * heterogeneous lookup: when Compare has a member type is_transparent
+         * (like std::less<>), these accept any K that Compare can compare with
+         * Key, so no temporary Key is built (e.g. a const char * for a
+         * std::string key).
+         * several keys may be equivalent to one K, so count and equal_range
+         * cover all of them; find and at return any one.
+         */
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator find(const K &x) {
+            NODE *t = mp.find(x);
+            if (t == nullptr) return end();
+            return iterator(t, this);
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator find(const K &x) const {
+            NODE *t = mp.find(x);
+            if (t == nullptr) return cend();
+            return const_iterator(t, this);
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        size_t count(const K &x) const {
+            size_t cnt = 0;
+            for (NODE *t = mp.lower_bound(x); t != mp.end_node && !Compare()(x, t->data()->first); t = mp.next(t))
+                cnt++;
+            return cnt;
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        T &at(const K &x) {
+            NODE *t = mp.find(x);
+            if (t == nullptr) throw index_out_of_bound();
+            return t->data()->second;
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const T &at(const K &x) const {
+            NODE *t = mp.find(x);
+            if (t == nullptr) throw index_out_of_bound();
+            return t->data()->second;
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator lower_bound(const K &x) {
+            return iterator(mp.lower_bound(x), this);
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator lower_bound(const K &x) const {
+            return const_iterator(mp.lower_bound(x), this);
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator upper_bound(const K &x) {
+            return iterator(mp.upper_bound(x), this);
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator upper_bound(const K &x) const {
+            return const_iterator(mp.upper_bound(x), this);
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        pair<iterator, iterator> equal_range(const K &x) {
+            return pair<iterator, iterator>(lower_bound(x), upper_bound(x));
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        pair<const_iterator, const_iterator> equal_range(const K &x) const {
+            return pair<const_iterator, const_iterator>(lower_bound(x), upper_bound(x));
+        }
+
+        /**
+         * the elements with keys in [a, b), empty if b is not greater than a.
+         * for (auto &v : mp.range(a, b)) visits them in key order.
+         */
+        range_type range(const Key &a, const Key &b) {
+            iterator first = lower_bound(a);
+            if (!Compare()(a, b)) return range_type(first, first);
+            return range_type(first, lower_bound(b));
+        }
+
+        const_range_type range(const Key &a, const Key &b) const {
+            const_iterator first = lower_bound(a);
+            if (!Compare()(a, b)) return const_range_type(first, first);
+            return const_range_type(first, lower_bound(b));
+        }
+
+        /**
+         * the number of keys less than key, in O(log n).
+         * only with order_statistics.
+         */
+        size_t rank(const Key &key) const {
+            static_assert(ranked, "rank() needs order_statistics");
+            return mp.rank(key);
+        }
+
+        /**
+         * the k-th smallest element (counting from 0), in O(log n).
+         * only with order_statistics.
+         * throw index_out_of_bound if k >= size().
+         */
+        iterator select(size_t k) {
+            static_assert(ranked, "select() needs order_statistics");
+            if (k >= size()) throw index_out_of_bound();
+            return iterator(mp.select(k), this);
+        }
+
+        const_iterator select(size_t k) const {
+            static_assert(ranked, "select() needs order_statistics");
+            if (k >= size()) throw index_out_of_bound();
+            return const_iterator(mp.select(k), this);
+        }
+
     };
 
+    //带顺序统计的map
+    template<class Key, class T, class Compare = std::less<Key> >
+    using ranked_map = map<Key, T, Compare, slab_allocator<pair<const Key, T> >, order_statistics>;
+
+    //迭代器加减是O(1)的map
+    template<class Key, class T, class Compare = std::less<Key> >
+    using threaded_map = map<Key, T, Compare, slab_allocator<pair<const Key, T> >, threaded_links>;
+
 }
 
 #endif
@@ -0,0 +1,60 @@
+// push/pop throughput of dary_heap against the node based priority_queue
+// g++ -O2 -std=c++14 -I../src dary_heap_throughput.cpp -o dary_heap_throughput          (scalar)
+// g++ -O2 -std=c++14 -mavx2 -I../src dary_heap_throughput.cpp -o dary_heap_throughput   (AVX2)
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+
+#include "dary_heap.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+const int N = 4000000;
+
+unsigned reed = 1727417277;
+
+unsigned next_rand() {
+	reed = reed * 1103515245u + 12345u;
+	return reed;
+}
+
+template<class Heap, class T>
+void bench(const char *name, T (*gen)()) {
+	Heap heap;
+	reed = 1727417277;
+	Clock::time_point st = Clock::now();
+	for (int i = 0; i < N; i++) heap.push(gen());
+	Clock::time_point mid = Clock::now();
+	T sum = 0;
+	while (!heap.empty()) {
+		sum += heap.top();
+		heap.pop();
+	}
+	Clock::time_point ed = Clock::now();
+	printf("%-32s push %6.1f ns/op   pop %6.1f ns/op   (%g)\n", name,
+	       std::chrono::duration<double, std::nano>(mid - st).count() / N,
+	       std::chrono::duration<double, std::nano>(ed - mid).count() / N, (double) sum);
+}
+
+int gen_int() {
+	return (int) (next_rand() >> 1);
+}
+
+long long gen_ll() {
+	return (long long) next_rand() << 20 | next_rand();
+}
+
+double gen_double() {
+	return next_rand() / 3.0;
+}
+
+int main() {
+	bench<sjtu::priority_queue<int> >("priority_queue<int>", gen_int);
+	bench<sjtu::priority_queue<int, std::less<int>, sjtu::leftist_heap> >("priority_queue<int, leftist>", gen_int);
+	bench<sjtu::dary_heap<int> >("dary_heap<int>", gen_int);
+	bench<sjtu::priority_queue<long long> >("priority_queue<long long>", gen_ll);
+	bench<sjtu::dary_heap<long long> >("dary_heap<long long>", gen_ll);
+	bench<sjtu::priority_queue<double> >("priority_queue<double>", gen_double);
+	bench<sjtu::dary_heap<double> >("dary_heap<double>", gen_double);
+	return 0;
+}
@@ -0,0 +1,65 @@
+// latency distribution (p50/p99/max) of push/pop/merge for every heap policy
+// g++ -O2 -std=c++14 -I../src heap_policy_latency.cpp -o heap_policy_latency
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+#include "priority_queue.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+const int N = 1000000;
+const int MERGES = 20000;
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+void report(const char *policy, const char *op, std::vector<long long> &ns) {
+	std::sort(ns.begin(), ns.end());
+	printf("%-10s %-6s p50 %8lld ns   p99 %8lld ns   max %10lld ns\n", policy, op,
+	       ns[ns.size() / 2], ns[ns.size() * 99 / 100], ns.back());
+}
+
+template<class Policy>
+void bench(const char *name) {
+	std::vector<long long> push_ns, pop_ns, merge_ns;
+	push_ns.reserve(N);
+	pop_ns.reserve(N);
+	merge_ns.reserve(MERGES);
+
+	sjtu::priority_queue<int, std::less<int>, Policy> pq;
+	//一半升序一半随机,升序插入会让斜堆的右链变得很长
+	for (int i = 0; i < N; i++) {
+		int x = (i & 1) ? i : rand();
+		Clock::time_point st = Clock::now();
+		pq.push(x);
+		push_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - st).count());
+	}
+	for (int i = 0; i < MERGES; i++) {
+		sjtu::priority_queue<int, std::less<int>, Policy> other;
+		for (int j = 0; j < 16; j++) other.push(rand());
+		Clock::time_point st = Clock::now();
+		pq.merge(other);
+		merge_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - st).count());
+	}
+	while (!pq.empty()) {
+		Clock::time_point st = Clock::now();
+		pq.pop();
+		pop_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - st).count());
+	}
+	report(name, "push", push_ns);
+	report(name, "pop", pop_ns);
+	report(name, "merge", merge_ns);
+}
+
+int main() {
+	bench<sjtu::skew_heap>("skew");
+	bench<sjtu::leftist_heap>("leftist");
+	bench<sjtu::binomial_heap>("binomial");
+	return 0;
+}
@@ -0,0 +1,40 @@
+// merge path histogram and right spine of every heap policy on the same workload
+// g++ -O2 -std=c++14 -I../src heap_policy_stats.cpp -o heap_policy_stats
+#include <iostream>
+#include <cstdio>
+
+#include "priority_queue.hpp"
+
+const int N = 1000000;
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+template<class Policy>
+void bench(const char *name) {
+	sjtu::priority_queue<int, std::less<int>, sjtu::instrumented<Policy> > pq;
+	//一半升序一半随机,和heap_policy_latency一样
+	for (int i = 0; i < N; i++) pq.push((i & 1) ? i : rand());
+	while (!pq.empty()) pq.pop();
+
+	sjtu::heap_stats st = pq.stats();
+	printf("%-10s merges %llu   max path %llu   max right spine %llu\n", name, st.merges, st.max_path,
+	       st.max_right_spine);
+	for (int i = 0; i < sjtu::heap_stats::BUCKETS; i++) {
+		if (st.path[i] == 0) continue;
+		printf("    path < %-8llu %10llu\n", 1ull << i, st.path[i]);
+	}
+	printf("    push %.1f ns/op   pop %.1f ns/op\n",
+	       (double) st.ns[sjtu::heap_stats::PUSH] / st.ops[sjtu::heap_stats::PUSH],
+	       (double) st.ns[sjtu::heap_stats::POP] / st.ops[sjtu::heap_stats::POP]);
+}
+
+int main() {
+	bench<sjtu::skew_heap>("skew");
+	bench<sjtu::leftist_heap>("leftist");
+	bench<sjtu::binomial_heap>("binomial");
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+
+#include "persistent_priority_queue.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+const int VERSIONS = 64;
+
+//随机地复制/push/pop/merge若干个版本,每一步都和std::priority_queue的副本对拍
+bool testfork()
+{
+	sjtu::persistent_priority_queue<int> pq[VERSIONS];
+	std::priority_queue<int> std_pq[VERSIONS];
+	for (int round = 0; round < 300000; round++) {
+		int a = rand() % VERSIONS, b = rand() % VERSIONS, op = rand() % 10;
+		if (op < 4) {
+			int x = rand() % 100000;
+			pq[a].push(x);
+			std_pq[a].push(x);
+		} else if (op < 7) {
+			if (!pq[a].empty()) {
+				pq[a].pop();
+				std_pq[a].pop();
+			}
+		} else if (op < 9) {
+			pq[a] = pq[b];
+			std_pq[a] = std_pq[b];
+		} else if (std_pq[a].size() + std_pq[b].size() < 5000) {
+			pq[a].merge(pq[b]);
+			std::priority_queue<int> tmp = std_pq[b];
+			while (!tmp.empty()) {
+				std_pq[a].push(tmp.top());
+				tmp.pop();
+			}
+		}
+		if (pq[a].size() != std_pq[a].size()) return false;
+		if (!pq[a].empty() && pq[a].top() != std_pq[a].top()) return false;
+		if (pq[b].size() != std_pq[b].size()) return false;
+	}
+	for (int i = 0; i < VERSIONS; i++) {
+		sjtu::persistent_priority_queue<int> snapshot(pq[i]);
+		size_t n = snapshot.size();
+		while (!std_pq[i].empty()) {
+			if (pq[i].top() != std_pq[i].top()) return false;
+			pq[i].pop();
+			std_pq[i].pop();
+		}
+		if (!pq[i].empty() || snapshot.size() != n) return false;
+	}
+	return true;
+}
+
+//很长的单链也不能爆栈
+bool testdeep()
+{
+	sjtu::persistent_priority_queue<int, std::greater<int> > pq;
+	for (int i = 0; i < 2000000; i++) pq.push(i);
+	sjtu::persistent_priority_queue<int, std::greater<int> > snapshot(pq);
+	for (int i = 0; i < 10; i++) pq.pop();
+	return pq.top() == 10 && snapshot.top() == 0 && snapshot.size() == 2000000;
+}
+
+int main()
+{
+	std::cout << (testfork() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testdeep() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
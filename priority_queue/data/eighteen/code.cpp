@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <vector>
+#include <functional>
+
+//不加-mavx2编译时也要测到dary_heap中AVX2的代码:
+//定义SJTU_DARY_FORCE_AVX2,选儿子的函数按avx2编译;main在运行前检查CPU是否支持
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SJTU_DARY_FORCE_AVX2
+#endif
+
+#include "dary_heap.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+#ifdef SJTU_DARY_AVX2
+//选的一定是向量版本的特化
+static_assert(sizeof(&sjtu::dary_select<long long, std::less<long long> >::max_epi64) > 0, "");
+#endif
+
+//和逐个比较的结果一致:最大值相同时取下标最小的
+template<class T, class Gen>
+bool testselect(Gen gen)
+{
+	T g[8];
+	for (int round = 0; round < 200000; round++) {
+		int cnt = round % 9 == 0 ? rand() % 8 + 1 : 8;
+		for (int i = 0; i < cnt; i++) g[i] = gen();
+		if (sjtu::dary_select<T, std::less<T> >::best(g, cnt) != sjtu::dary_best_scalar<T, std::less<T> >(g, cnt))
+			return false;
+	}
+	return true;
+}
+
+//fast_priority_queue对这三种类型就是dary_heap
+template<class T, class Gen>
+bool testqueue(Gen gen)
+{
+	sjtu::fast_priority_queue<T> heap, other;
+	std::priority_queue<T> std_heap;
+	for (int round = 0; round < 300000; round++) {
+		int op = rand() % 16;
+		if (op < 8) {
+			T x = gen();
+			heap.push(x);
+			std_heap.push(x);
+		} else if (op < 15) {
+			if (!std_heap.empty()) {
+				if (heap.top() != std_heap.top()) return false;
+				heap.pop();
+				std_heap.pop();
+			}
+		} else {
+			for (int i = rand() % 100; i > 0; i--) {
+				T x = gen();
+				other.push(x);
+				std_heap.push(x);
+			}
+			heap.merge(other);
+		}
+	}
+	while (!std_heap.empty()) {
+		if (heap.top() != std_heap.top()) return false;
+		heap.pop();
+		std_heap.pop();
+	}
+	return heap.empty();
+}
+
+bool testall()
+{
+	//取值范围小,一组里经常有相同的最大值
+	return testselect<int>([] { return rand() % 8 - 4; }) &&
+	       testselect<int>([] { return rand() - (1 << 30); }) &&
+	       testselect<long long>([] { return (long long) (rand() % 8 - 4) << 33; }) &&
+	       testselect<long long>([] { return (long long) rand() * rand() - (1ll << 50); }) &&
+	       testselect<double>([] { return (rand() % 5 - 2) * 0.5; }) &&
+	       testselect<double>([] { return rand() % 2 ? 0.0 : -0.0; }) &&
+	       testqueue<int>([] { return rand() % 1000; }) &&
+	       testqueue<long long>([] { return (long long) rand() * rand() - (1ll << 50); }) &&
+	       testqueue<double>([] { return rand() / 7.0; });
+}
+
+int main()
+{
+#ifdef SJTU_DARY_AVX2
+	//不支持时输出SKIP而不是OKAY,和通过区分开
+	if (!__builtin_cpu_supports("avx2")) {
+		std::cout << "SKIP: no AVX2 on this CPU" << std::endl;
+		return 0;
+	}
+#endif
+	std::cout << (testall() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
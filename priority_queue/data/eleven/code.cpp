@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <string>
+
+#include "dary_heap.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+template<class T, class Compare, class Gen>
+bool testheap(Gen gen)
+{
+	sjtu::dary_heap<T, Compare> heap, other;
+	std::priority_queue<T, std::vector<T>, Compare> std_heap, std_other;
+	for (int round = 0; round < 300000; round++) {
+		int op = rand() % 16;
+		if (op < 8) {
+			T x = gen();
+			heap.push(x);
+			std_heap.push(x);
+		} else if (op < 14) {
+			if (!std_heap.empty()) {
+				if (heap.top() != std_heap.top()) return false;
+				if (op & 1) heap.pop();
+				else if (heap.pop_top() != std_heap.top()) return false;
+				std_heap.pop();
+			}
+		} else if (op < 15) {
+			T x = gen();
+			other.push(x);
+			std_other.push(x);
+		} else {
+			heap.merge(other);
+			if (!other.empty()) return false;
+			for (; !std_other.empty(); std_other.pop()) std_heap.push(std_other.top());
+		}
+	}
+	heap.merge(other);
+	for (; !std_other.empty(); std_other.pop()) std_heap.push(std_other.top());
+	sjtu::dary_heap<T, Compare> copy(heap);
+	if (copy.size() != std_heap.size()) return false;
+	while (!std_heap.empty()) {
+		if (copy.top() != std_heap.top()) return false;
+		copy.pop();
+		std_heap.pop();
+	}
+	return copy.empty() && heap.size() > 0;
+}
+
+int main()
+{
+	std::cout << (testheap<int, std::less<int> >([] { return rand() % 1000; }) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testheap<long long, std::less<long long> >([] { return (long long) rand() * rand() - (1ll << 50); }) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testheap<double, std::less<double> >([] { return rand() / 7.0; }) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testheap<std::string, std::greater<std::string> >([] { return std::to_string(rand() % 100000); }) ? "OKAY" : "FAIL") << std::endl;
+
+	sjtu::fast_priority_queue<int> fast;
+	sjtu::fast_priority_queue<std::string> general;
+	fast.push(1);
+	general.push("1");
+	std::cout << fast.top() << " " << general.top() << std::endl;
+	return 0;
+}
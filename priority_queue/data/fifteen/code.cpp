@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+#include "timing_wheel.hpp"
+
+unsigned long long reed = 1727417277;
+
+unsigned long long rand64() {
+	reed = reed * 6364136223846793005ull + 1442695040888963407ull;
+	return reed >> 11;
+}
+
+struct Event {
+	unsigned long long deadline;
+	int id;
+};
+
+//和std::map对拍: 随机调度/取消/推进时间,时间跨度从几个tick到超过2^32
+bool testwheel()
+{
+	sjtu::timing_wheel<Event> wheel(12345);
+	std::map<int, sjtu::timing_wheel<Event>::handle> handles;
+	std::set<std::pair<unsigned long long, int> > pending;
+	unsigned long long now = 12345;
+	int id = 0;
+	std::vector<Event> fired;
+	for (int round = 0; round < 400000; round++) {
+		int op = rand64() % 10;
+		if (op < 5) {
+			unsigned long long span;
+			switch (rand64() % 5) {
+				case 0: span = rand64() % 4; break;
+				case 1: span = rand64() % 300; break;
+				case 2: span = rand64() % 100000; break;
+				case 3: span = rand64() % (1ull << 33); break;
+				default: span = rand64() % (1ull << 40); break;
+			}
+			unsigned long long deadline = now + span - (span > 0 && rand64() % 50 == 0 ? span + 1 : 0);
+			if (deadline > now + span) deadline = now;
+			Event e = {deadline, ++id};
+			handles[id] = wheel.schedule(deadline, e);
+			pending.insert(std::make_pair(deadline, id));
+		} else if (op < 8) {
+			if (handles.empty()) continue;
+			std::map<int, sjtu::timing_wheel<Event>::handle>::iterator it = handles.lower_bound((int) (rand64() % (id + 1)));
+			if (it == handles.end()) continue;
+			bool alive = false;
+			for (std::set<std::pair<unsigned long long, int> >::iterator p = pending.begin(); p != pending.end() && !alive; ++p)
+				if (p->second == it->first) {
+					alive = true;
+					pending.erase(p);
+					break;
+				}
+			if (wheel.cancel(it->second) != alive) return false;
+			if (wheel.cancel(it->second)) return false;
+			handles.erase(it);
+		} else {
+			unsigned long long step;
+			switch (rand64() % 4) {
+				case 0: step = rand64() % 10; break;
+				case 1: step = rand64() % 1000; break;
+				case 2: step = rand64() % 10000000; break;
+				default: step = rand64() % (1ull << 36); break;
+			}
+			unsigned long long last = now;
+			now += step;
+			fired.clear();
+			wheel.advance(now, std::back_inserter(fired));
+			for (size_t i = 0; i < fired.size(); i++) {
+				if (fired[i].deadline > now) return false;
+				//调度时已经过期的按调度顺序最先取出,其余按时间顺序
+				if (i && fired[i - 1].deadline > last && fired[i].deadline < fired[i - 1].deadline) return false;
+				if (!pending.erase(std::make_pair(fired[i].deadline, fired[i].id))) return false;
+				handles.erase(fired[i].id);
+			}
+			if (!pending.empty() && pending.begin()->first <= now) return false;
+		}
+		if (wheel.size() != pending.size() || wheel.now() != now) return false;
+	}
+	return true;
+}
+
+//记下还活着的payload
+long long alive = 0;
+
+struct Tracked {
+	int id;
+	Tracked(int _id = -1) : id(_id) {
+		alive++;
+	}
+	Tracked(const Tracked &other) : id(other.id) {
+		alive++;
+	}
+	Tracked &operator=(const Tracked &other) {
+		id = other.id;
+		return *this;
+	}
+	~Tracked() {
+		alive--;
+	}
+};
+
+//写到第limit个时抛异常的输出迭代器
+struct Limited {
+	std::vector<int> *got;
+	int limit;
+	Limited &operator*() {
+		return *this;
+	}
+	Limited &operator=(const Tracked &t) {
+		if ((int) got->size() == limit) throw 1;
+		got->push_back(t.id);
+		return *this;
+	}
+	Limited &operator++() {
+		return *this;
+	}
+};
+
+//写out失败时定时器不能丢也不能漏掉释放,下一次advance按顺序接着取
+bool testthrow()
+{
+	{
+		sjtu::timing_wheel<Tracked> wheel(0);
+		std::vector<std::pair<unsigned long long, int> > all;
+		for (int i = 0; i < 3000; i++) {
+			//有的在第0层,有的要从上层拆下来,有的和别人同时到期
+			unsigned long long d = rand64() % 3 == 0 ? 700 : rand64() % 100000;
+			wheel.schedule(d, Tracked(i));
+			all.push_back(std::make_pair(d, i));
+		}
+		std::stable_sort(all.begin(), all.end(),
+		                 [](const std::pair<unsigned long long, int> &a, const std::pair<unsigned long long, int> &b) {
+			                 return a.first < b.first;
+		                 });
+		std::vector<int> got;
+		for (int limit = 100; got.size() < all.size(); limit += 100 + rand64() % 500) {
+			try {
+				wheel.advance(100000, Limited{&got, limit});
+			} catch (int) {}
+			if (wheel.size() != all.size() - got.size() || alive != (long long) wheel.size()) return false;
+		}
+		for (size_t i = 0; i < all.size(); i++)
+			if (got[i] != all[i].second) return false;
+		if (!wheel.empty()) return false;
+	}
+	return alive == 0;
+}
+
+int main()
+{
+	std::cout << (testwheel() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthrow() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
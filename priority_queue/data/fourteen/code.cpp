@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <vector>
+#include <iterator>
+
+#include "priority_queue.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+template<class Policy>
+bool testbatch()
+{
+	sjtu::priority_queue<int, std::less<int>, Policy> pq;
+	std::priority_queue<int> std_pq;
+	std::vector<int> batch, drained;
+	for (int round = 0; round < 2000; round++) {
+		batch.clear();
+		int m = rand() % 500;
+		for (int i = 0; i < m; i++) batch.push_back(rand() % 100000);
+		pq.push_range(batch.begin(), batch.end());
+		for (int i = 0; i < m; i++) std_pq.push(batch[i]);
+
+		int k = rand() % 300;
+		if ((size_t) k > std_pq.size()) {
+			try {
+				pq.pop_n(k, std::back_inserter(drained));
+				return false;
+			} catch (sjtu::container_is_empty) {}
+			continue;
+		}
+		drained.clear();
+		pq.pop_n(k, std::back_inserter(drained));
+		if (drained.size() != (size_t) k) return false;
+		for (int i = 0; i < k; i++) {
+			if (drained[i] != std_pq.top()) return false;
+			std_pq.pop();
+		}
+		if (pq.size() != std_pq.size()) return false;
+	}
+	int rest[100];
+	int *end = pq.pop_n(100, rest);
+	for (int i = 0; i < 100; i++) {
+		if (rest[i] != std_pq.top()) return false;
+		std_pq.pop();
+	}
+	return end == rest + 100 && pq.size() == std_pq.size();
+}
+
+//写到第limit个时抛异常的输出迭代器
+struct Limited {
+	int *buf, *cnt, limit;
+	Limited &operator*() {
+		return *this;
+	}
+	Limited &operator=(int v) {
+		if (*cnt == limit) throw 1;
+		buf[(*cnt)++] = v;
+		return *this;
+	}
+	Limited &operator++() {
+		return *this;
+	}
+};
+
+//写out失败时,已经删掉的元素不再算在size里
+template<class Policy>
+bool testthrow()
+{
+	sjtu::priority_queue<int, std::less<int>, Policy> pq;
+	std::priority_queue<int> std_pq;
+	for (int i = 0; i < 1000; i++) {
+		int x = rand() % 100000;
+		pq.push(x);
+		std_pq.push(x);
+	}
+	int buf[100], cnt = 0;
+	Limited out = {buf, &cnt, 37};
+	try {
+		pq.pop_n(100, out);
+		return false;
+	} catch (int) {}
+	for (int i = 0; i < cnt; i++) {
+		if (buf[i] != std_pq.top()) return false;
+		std_pq.pop();
+	}
+	if (cnt != 37 || pq.size() != std_pq.size()) return false;
+	while (!std_pq.empty()) {
+		if (pq.top() != std_pq.top()) return false;
+		pq.pop();
+		std_pq.pop();
+	}
+	return pq.empty();
+}
+
+int main()
+{
+	std::cout << (testbatch<sjtu::skew_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testbatch<sjtu::leftist_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testbatch<sjtu::binomial_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthrow<sjtu::skew_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthrow<sjtu::leftist_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testthrow<sjtu::binomial_heap>() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <csignal>
+#include <dirent.h>
+#include <sys/resource.h>
+
+#include "external_priority_queue.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+struct Event {
+	long long time;
+	int id;
+};
+
+struct Later {
+	bool operator()(const Event &a, const Event &b) const {
+		return a.time > b.time || (a.time == b.time && a.id > b.id);
+	}
+};
+
+//内存预算只有64KB,一百万个元素一定会写到外存里
+bool testspill()
+{
+	sjtu::external_priority_queue<Event, Later> pq(64 << 10, 4 << 10);
+	std::priority_queue<Event, std::vector<Event>, Later> std_pq;
+	int id = 0;
+	for (int round = 0; round < 1000000; round++) {
+		if (rand() % 4) {
+			Event e = {rand() % 10000000, id++};
+			pq.push(e);
+			std_pq.push(e);
+		} else if (!pq.empty()) {
+			if (pq.top().id != std_pq.top().id) return false;
+			pq.pop();
+			std_pq.pop();
+		}
+		if (pq.size() != std_pq.size()) return false;
+	}
+	if (pq.bytes_written() == 0 || pq.run_count() == 0) return false;
+	while (!std_pq.empty()) {
+		if (pq.top().id != std_pq.top().id) return false;
+		pq.pop();
+		std_pq.pop();
+	}
+	try {
+		pq.pop();
+		return false;
+	} catch (sjtu::container_is_empty) {}
+	return pq.empty() && pq.run_count() == 0 && pq.bytes_read() == pq.bytes_written();
+}
+
+int open_files()
+{
+	int n = 0;
+	DIR *d = opendir("/proc/self/fd");
+	if (d == nullptr) return -1;
+	while (readdir(d)) n++;
+	closedir(d);
+	return n;
+}
+
+//文件大小受限,写段失败时元素不能丢,也不能留下打开的临时文件
+//20KB时只有归并会失败,8KB时写一个段也会失败
+bool testfail(int limit)
+{
+	signal(SIGXFSZ, SIG_IGN);
+	rlimit old;
+	getrlimit(RLIMIT_FSIZE, &old);
+	int files = open_files();
+	bool ok = true;
+	{
+		sjtu::external_priority_queue<Event, Later> pq(64 << 10, 4 << 10);
+		std::priority_queue<Event, std::vector<Event>, Later> std_pq;
+		rlimit small = old;
+		small.rlim_cur = limit;
+		setrlimit(RLIMIT_FSIZE, &small);
+		int failures = 0;
+		for (int id = 0; id < 30000; id++) {
+			Event e = {rand() % 10000000, id};
+			try {
+				pq.push(e);
+				std_pq.push(e);
+			} catch (sjtu::runtime_error) {
+				failures++;
+			}
+			if (pq.size() != std_pq.size() || pq.top().id != std_pq.top().id) ok = false;
+		}
+		if (failures == 0 || open_files() != files + pq.run_count()) ok = false;
+		//限制去掉之后可以继续写
+		setrlimit(RLIMIT_FSIZE, &old);
+		for (int id = 30000; id < 60000; id++) {
+			Event e = {rand() % 10000000, id};
+			pq.push(e);
+			std_pq.push(e);
+		}
+		while (!std_pq.empty()) {
+			if (pq.top().id != std_pq.top().id) ok = false;
+			pq.pop();
+			std_pq.pop();
+		}
+		ok = ok && pq.empty();
+	}
+	setrlimit(RLIMIT_FSIZE, &old);
+	return ok && open_files() == files;
+}
+
+int main()
+{
+	std::cout << (testspill() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testfail(20 << 10) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testfail(8 << 10) ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
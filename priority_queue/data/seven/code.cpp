@@ -0,0 +1,65 @@
+#include <iostream>
+#include <cstdio>
+#include <string>
+
+#include "priority_queue.hpp"
+
+//记录复制次数,检查 push(T&&)/emplace/pop_top 没有多余的深拷贝
+class Event {
+public:
+	static int copies;
+	int time;
+	std::string name;
+
+	Event(int t, const std::string &n) : time(t), name(n) {}
+
+	Event(const Event &other) : time(other.time), name(other.name) {
+		copies++;
+	}
+
+	Event(Event &&other) : time(other.time), name(std::move(other.name)) {}
+
+	Event &operator=(const Event &other) = delete;
+};
+
+int Event::copies = 0;
+
+struct Later {
+	bool operator()(const Event &a, const Event &b) const {
+		return a.time > b.time;
+	}
+};
+
+template<class Policy>
+void test(const char *name) {
+	Event::copies = 0;
+	sjtu::priority_queue<Event, Later, Policy> pq;
+	for (int i = 0; i < 1000; i++) {
+		if (i & 1) pq.push(Event((i * 37) % 1000, "push"));
+		else pq.emplace((i * 37) % 1000, "emplace");
+	}
+	sjtu::priority_queue<Event, Later, Policy> moved(std::move(pq));
+	sjtu::priority_queue<Event, Later, Policy> assigned;
+	assigned = std::move(moved);
+	std::cout << name << " " << pq.size() << " " << moved.size() << " " << assigned.size() << std::endl;
+	int last = -1;
+	bool ordered = true;
+	while (assigned.size() > 500) {
+		Event e = assigned.pop_top();
+		if (e.time < last || e.name.empty()) ordered = false;
+		last = e.time;
+	}
+	std::cout << (ordered ? "ordered" : "unordered") << " " << assigned.top().time << " copies " << Event::copies << std::endl;
+	try {
+		pq.pop_top();
+	} catch (sjtu::container_is_empty) {
+		std::cout << "empty" << std::endl;
+	}
+}
+
+int main() {
+	test<sjtu::skew_heap>("skew");
+	test<sjtu::leftist_heap>("leftist");
+	test<sjtu::binomial_heap>("binomial");
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <vector>
+
+#include "priority_queue.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+struct Plain {
+	void *root;
+	int len;
+	void *pool;
+};
+
+template<class Policy>
+bool teststats(unsigned long long spine_limit)
+{
+	typedef sjtu::priority_queue<int, std::less<int>, sjtu::instrumented<Policy> > Queue;
+	Queue pq;
+	std::priority_queue<int> std_pq;
+	const int N = 50000;
+	unsigned long long pushes = 0, pops = 0, merges = 0;
+	for (int i = 0; i < N; i++) {
+		int x = rand() % 1000000;
+		pq.push(x);
+		std_pq.push(x);
+		pushes++;
+		if (i % 100 == 99) {
+			Queue other;
+			for (int j = 0; j < 10; j++) {
+				int y = rand();
+				other.push(y);
+				std_pq.push(y);
+			}
+			pq.merge(other);
+			merges++;
+			//other的节点已经归pq所有
+			sjtu::heap_stats os = other.stats();
+			if (os.allocations != 10 || os.frees != 0 || os.ops[sjtu::heap_stats::PUSH] != 10) return false;
+		}
+		if (i % 3 == 0) {
+			if (pq.top() != std_pq.top()) return false;
+			pq.pop();
+			std_pq.pop();
+			pops++;
+		}
+	}
+	sjtu::heap_stats st = pq.stats();
+	if (st.allocations != pushes || st.frees != pops) return false;
+	if (st.ops[sjtu::heap_stats::PUSH] != pushes || st.ops[sjtu::heap_stats::POP] != pops ||
+	    st.ops[sjtu::heap_stats::MERGE] != merges) return false;
+	//每次push/pop/merge内部恰好合并一次
+	unsigned long long sum = 0;
+	for (int i = 0; i < sjtu::heap_stats::BUCKETS; i++) sum += st.path[i];
+	if (sum != st.merges || st.merges != pushes + pops + merges) return false;
+	if (st.max_path == 0 || st.max_right_spine == 0 || st.max_right_spine > spine_limit) return false;
+
+	//空的pop不会被计数
+	pq.reset_stats();
+	Queue empty;
+	try {
+		empty.pop();
+		return false;
+	} catch (sjtu::container_is_empty) {}
+	if (empty.stats().ops[sjtu::heap_stats::POP] != 0 || pq.stats().merges != 0) return false;
+
+	while (!std_pq.empty()) {
+		if (pq.top() != std_pq.top()) return false;
+		pq.pop();
+		std_pq.pop();
+	}
+	return pq.stats().frees == pq.stats().ops[sjtu::heap_stats::POP];
+}
+
+int main()
+{
+	//不统计时队列的大小不变
+	std::cout << (sizeof(sjtu::priority_queue<int>) == sizeof(Plain) &&
+	              sizeof(sjtu::priority_queue<int, std::less<int>, sjtu::binomial_heap>) == sizeof(Plain) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (teststats<sjtu::skew_heap>(100000) ? "OKAY" : "FAIL") << std::endl;
+	//左偏树的右链不超过log(n+1),二项堆的根链表不超过log(n)+1
+	std::cout << (teststats<sjtu::leftist_heap>(17) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (teststats<sjtu::binomial_heap>(18) ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
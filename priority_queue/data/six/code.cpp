@@ -0,0 +1,74 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <vector>
+
+#include "priority_queue.hpp"
+
+int rand() {
+	static int reed = 1727417277;
+	return (reed += (reed << 5) + 172741827);
+}
+
+template<class Policy>
+bool testpolicy()
+{
+	sjtu::priority_queue<int, std::less<int>, Policy> pq, other;
+	std::priority_queue<int> std_pq, std_other;
+	for (int round = 0; round < 200000; round++) {
+		int op = (unsigned) rand() % 10;
+		if (op < 5) {
+			int x = rand() % 1000;
+			pq.push(x);
+			std_pq.push(x);
+		} else if (op < 8) {
+			if (pq.size() != std_pq.size()) return false;
+			if (!pq.empty()) {
+				if (pq.top() != std_pq.top()) return false;
+				pq.pop();
+				std_pq.pop();
+			}
+		} else if (op < 9) {
+			int x = rand();
+			other.push(x);
+			std_other.push(x);
+		} else {
+			pq.merge(other);
+			while (!std_other.empty()) {
+				std_pq.push(std_other.top());
+				std_other.pop();
+			}
+			if (!other.empty()) return false;
+		}
+	}
+	sjtu::priority_queue<int, std::less<int>, Policy> copy(pq);
+	pq = copy;
+	if (pq.size() != std_pq.size() || copy.size() != std_pq.size()) return false;
+	while (!std_pq.empty()) {
+		if (pq.top() != std_pq.top() || copy.top() != std_pq.top()) return false;
+		pq.pop();
+		copy.pop();
+		std_pq.pop();
+	}
+	try {
+		pq.pop();
+		return false;
+	} catch (...) {}
+	return pq.empty() && copy.empty();
+}
+
+//斜堆的节点不带rank,只有数据和两个指针
+struct SkewNode {
+	int data;
+	void *left, *right;
+};
+
+int main(int argc, char *const argv[])
+{
+	std::cout << (sjtu::priority_queue<int>::node_size == sizeof(SkewNode) &&
+	              sjtu::priority_queue<int, std::less<int>, sjtu::leftist_heap>::node_size >= sizeof(SkewNode) ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testpolicy<sjtu::skew_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testpolicy<sjtu::leftist_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testpolicy<sjtu::binomial_heap>() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <cstdio>
+#include <queue>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "minmax_heap.hpp"
+#include "dary_heap.hpp"
+#include "persistent_priority_queue.hpp"
+#include "external_priority_queue.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+//按外部数组里的分数比较编号,元素本身只存编号
+class ByScore {
+	const int *score;
+public:
+	ByScore(const int *s = nullptr) : score(s) {}
+	bool operator()(int a, int b) const {
+		return score[a] < score[b] || (score[a] == score[b] && a < b);
+	}
+};
+
+bool less_int(const int &a, const int &b) {
+	return a < b;
+}
+
+struct Empty {
+	bool operator()(int a, int b) const {
+		return a > b;
+	}
+};
+
+struct Plain {
+	void *root;
+	int len;
+	void *pool;
+};
+
+const int N = 20000;
+int score_a[N], score_b[N];
+
+template<class Policy>
+bool testscore()
+{
+	ByScore ca(score_a), cb(score_b);
+	sjtu::priority_queue<int, ByScore, Policy> pa(ca), pb(cb);
+	std::priority_queue<int, std::vector<int>, ByScore> sa(ca), sb(cb);
+	for (int i = 0; i < N; i++) {
+		pa.push(i);
+		sa.push(i);
+		pb.push(i);
+		sb.push(i);
+	}
+	//复制和移动都要带上比较器
+	sjtu::priority_queue<int, ByScore, Policy> copy(pb), moved(std::move(pa)), assigned;
+	assigned = copy;
+	pa = std::move(moved);
+	for (int i = 0; i < N; i++) {
+		if (pa.top() != sa.top() || pb.top() != sb.top() || assigned.top() != sb.top()) return false;
+		if (pa.value_comp()(pa.top(), pb.top()) != ca(pa.top(), pb.top())) return false;
+		pa.pop();
+		sa.pop();
+		pb.pop();
+		sb.pop();
+		assigned.pop();
+	}
+	return pa.empty() && pb.empty() && assigned.empty();
+}
+
+bool testother()
+{
+	//函数指针作为比较器
+	sjtu::priority_queue<int, bool (*)(const int &, const int &)> pf(less_int);
+	for (int i = 0; i < 1000; i++) pf.push(rand() % 100);
+	int last = 100;
+	while (!pf.empty()) {
+		if (pf.top() > last) return false;
+		last = pf.top();
+		pf.pop();
+	}
+
+	//pool加比较器
+	sjtu::priority_queue<int, ByScore>::pool_type pool;
+	sjtu::priority_queue<int, ByScore> p1(pool, ByScore(score_a)), p2(pool, ByScore(score_a));
+	std::priority_queue<int, std::vector<int>, ByScore> s1((ByScore(score_a)));
+	for (int i = 0; i < 1000; i++) {
+		p1.push(i);
+		p2.push(N - 1 - i);
+		s1.push(i);
+		s1.push(N - 1 - i);
+	}
+	p1.merge(p2);
+
+	//kway_merge用同一个比较器按顺序读出
+	sjtu::priority_queue<int, ByScore> p3(score_a);
+	std::vector<int> sorted;
+	for (int i = 1000; i < 3000; i++) {
+		if (i & 1) p3.push(i);
+		else sorted.push_back(i);
+	}
+	std::priority_queue<int, std::vector<int>, ByScore> s3((ByScore(score_a)));
+	for (int i = 1000; i < 3000; i++) s3.push(i);
+	std::vector<int> rev;
+	while (!s3.empty()) {
+		if (!(s3.top() & 1)) rev.push_back(s3.top());
+		s3.pop();
+	}
+	for (int i = 1000; i < 3000; i++) s1.push(i);
+	sjtu::kway_merge<int, ByScore> km((ByScore(score_a)));
+	km.add(p1);
+	km.add(p3);
+	km.add(rev.data(), rev.data() + rev.size());
+	while (!s1.empty()) {
+		if (km.empty() || km.top() != s1.top()) return false;
+		km.pop();
+		s1.pop();
+	}
+	return km.empty();
+}
+
+//其他几种队列也保存传入的比较器
+bool testsiblings()
+{
+	ByScore ca(score_a), cb(score_b);
+	sjtu::minmax_heap<int, ByScore> mm(ca);
+	sjtu::dary_heap<int, ByScore> dh(ca);
+	sjtu::persistent_priority_queue<int, ByScore> pp(ca);
+	sjtu::external_priority_queue<int, ByScore> ep(16 << 10, 1 << 10, ca);
+	std::priority_queue<int, std::vector<int>, ByScore> sa(ca);
+	std::priority_queue<int, std::vector<int>, ByScore> smin((ByScore(score_b)));
+	for (int i = 0; i < N; i++) {
+		mm.push(i);
+		dh.push(i);
+		pp.push(i);
+		ep.push(i);
+		sa.push(i);
+	}
+	if (ep.run_count() == 0) return false;
+	//复制、移动、赋值都带上比较器
+	sjtu::minmax_heap<int, ByScore> mm_copy(mm), mm_b(cb);
+	sjtu::dary_heap<int, ByScore> dh_moved(std::move(dh)), dh_b(cb);
+	sjtu::persistent_priority_queue<int, ByScore> pp_copy, pp_b(cb);
+	pp_copy = pp;
+	for (int i = 0; i < N; i++) {
+		mm_b.push(i);
+		dh_b.push(i);
+		pp_b.push(i);
+	}
+	mm = mm_b;
+	dh = std::move(dh_b);
+	if (mm.value_comp()(1, 2) != cb(1, 2) || dh.value_comp()(1, 2) != cb(1, 2) ||
+	    ep.value_comp()(1, 2) != ca(1, 2)) return false;
+	for (int i = 0; i < N; i++) smin.push(i);
+	//smin是按score_b的大根堆,倒过来就是mm的最小值序列
+	std::vector<int> by_b;
+	while (!smin.empty()) {
+		by_b.push_back(smin.top());
+		smin.pop();
+	}
+	for (int i = 0; i < N; i++) {
+		int x = sa.top();
+		if (mm_copy.top_max() != x || dh_moved.top() != x || pp_copy.top() != x || ep.top() != x) return false;
+		if (i < N / 2 && (mm.top_max() != by_b[i] || mm.top_min() != by_b[N - 1 - i])) return false;
+		if (dh.top() != by_b[i] || pp_b.top() != by_b[i]) return false;
+		mm_copy.pop_max();
+		dh_moved.pop();
+		pp_copy.pop();
+		ep.pop();
+		sa.pop();
+		if (i < N / 2) {
+			mm.pop_max();
+			mm.pop_min();
+		}
+		dh.pop();
+		pp_b.pop();
+	}
+	return mm_copy.empty() && dh_moved.empty() && pp_copy.empty() && ep.empty() && mm.empty() && dh.empty();
+}
+
+int main()
+{
+	for (int i = 0; i < N; i++) {
+		score_a[i] = rand() % 1000;
+		score_b[i] = rand() % 1000;
+	}
+	//没有状态的比较器不占空间
+	bool ebo = sizeof(sjtu::priority_queue<int>) == sizeof(Plain) &&
+	           sizeof(sjtu::priority_queue<int, Empty>) == sizeof(Plain) &&
+	           sizeof(sjtu::priority_queue<int, ByScore>) > sizeof(Plain);
+	std::cout << (ebo ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testscore<sjtu::skew_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testscore<sjtu::leftist_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testscore<sjtu::binomial_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testother() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testsiblings() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
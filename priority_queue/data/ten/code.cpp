@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cstdio>
+#include <set>
+#include <string>
+
+#include "minmax_heap.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+class T1//no default constructor
+{
+public:
+	int data;
+	std::string tag;
+	T1(int key) : data(key), tag("heap") {}
+};
+
+struct Cmp {
+	bool operator()(const T1 &a, const T1 &b) const {
+		return a.data < b.data;
+	}
+};
+
+bool testrandom()
+{
+	sjtu::minmax_heap<T1, Cmp> heap;
+	std::multiset<int> st;
+	for (int round = 0; round < 500000; round++) {
+		int op = rand() % 5;
+		if (op < 2) {
+			int x = rand() % 100000;
+			heap.push(T1(x));
+			st.insert(x);
+		} else if (op == 2 && !st.empty()) {
+			if (heap.top_min().data != *st.begin()) return false;
+			heap.pop_min();
+			st.erase(st.begin());
+		} else if (op == 3 && !st.empty()) {
+			if (heap.top_max().data != *st.rbegin()) return false;
+			heap.pop_max();
+			st.erase(--st.end());
+		} else if (op == 4 && round % 1000 == 0) {
+			sjtu::minmax_heap<T1, Cmp> copy(heap);
+			heap = copy;
+		}
+		if (heap.size() != st.size()) return false;
+	}
+	while (!st.empty()) {
+		if (heap.top_min().data != *st.begin() || heap.top_max().data != *st.rbegin()) return false;
+		if (st.size() & 1) {
+			heap.pop_min();
+			st.erase(st.begin());
+		} else {
+			heap.pop_max();
+			st.erase(--st.end());
+		}
+	}
+	try {
+		heap.top_max();
+		return false;
+	} catch (sjtu::container_is_empty) {}
+	return heap.empty();
+}
+
+int main()
+{
+	std::cout << (testrandom() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <new>
+#include <cstdlib>
+
+#include "priority_queue.hpp"
+
+//node_pool的每一块都是用new[]申请的
+int chunk_allocs = 0;
+
+void *operator new[](size_t n)
+{
+	chunk_allocs++;
+	void *p = malloc(n);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+//升序插入会让斜堆退化成一条长度为n的左链,递归的复制和析构会爆栈
+bool testdeep()
+{
+	const int N = 3000000;
+	sjtu::priority_queue<int> pq;
+	for (int i = 0; i < N; i++) pq.push(i);
+	sjtu::priority_queue<int> copy(pq);
+	pq = copy;
+	for (int i = N - 1; i >= N - 10; i--) {
+		if (pq.top() != i || copy.top() != i) return false;
+		pq.pop();
+		copy.pop();
+	}
+	return pq.size() == N - 10 && copy.size() == N - 10;
+}
+
+//所有节点从pool中分配,析构时不再逐个释放
+bool testpool()
+{
+	sjtu::priority_queue<long long>::pool_type pool;
+	{
+		sjtu::priority_queue<long long> a(pool), b(pool);
+		for (int i = 0; i < 100000; i++) {
+			a.push((long long) i * 7919 % 100003);
+			b.push((long long) i * 104729 % 100019);
+		}
+		for (int i = 0; i < 50000; i++) a.pop();
+		sjtu::priority_queue<long long> c(a);
+		a.merge(b);
+		if (!b.empty() || a.size() != 150000 || c.size() != 50000) return false;
+		long long last = a.top();
+		while (!a.empty()) {
+			if (a.top() > last) return false;
+			last = a.top();
+			a.pop();
+		}
+		sjtu::priority_queue<long long> other;
+		other.push(1);
+		try {
+			c.merge(other);
+			return false;
+		} catch (sjtu::runtime_error) {}
+	}
+	pool.release();
+
+	//析构的队列把节点还给pool,同一个pool反复建队列不会一直申请新的块
+	for (int round = 0; round < 100; round++) {
+		sjtu::priority_queue<long long> q(pool);
+		for (int i = 0; i < 10000; i++) q.push(i);
+		if (round == 0) chunk_allocs = 0;
+	}
+	if (chunk_allocs != 0) return false;
+	//discard不还节点,由release一起释放
+	{
+		sjtu::priority_queue<long long> q(pool);
+		for (int i = 0; i < 1000; i++) q.push(i);
+		q.discard();
+		if (!q.empty()) return false;
+		q.push(5);
+		if (q.top() != 5) return false;
+	}
+	pool.release();
+
+	sjtu::priority_queue<std::string>::pool_type string_pool;
+	sjtu::priority_queue<std::string> s(string_pool);
+	for (int i = 0; i < 1000; i++) s.push(std::to_string(i));
+	sjtu::priority_queue<std::string> t;
+	t = s;
+	t.pop();
+	return s.top() == "999" && t.top() == "998";
+}
+
+//拷贝构造改一个普通的全局计数器,复制不能在多个线程里调用它
+int copies = 0;
+
+struct Counted {
+	int v;
+	Counted(int _v = 0) : v(_v) {}
+	Counted(const Counted &other) : v(other.v) {
+		copies++;
+	}
+	Counted &operator=(const Counted &other) {
+		v = other.v;
+		return *this;
+	}
+	bool operator<(const Counted &other) const {
+		return v < other.v;
+	}
+};
+
+bool testshared()
+{
+	const int N = 200000;
+	sjtu::priority_queue<Counted> pq;
+	for (int i = 0; i < N; i++) pq.push(Counted(i * 7919 % N));
+	copies = 0;
+	sjtu::priority_queue<Counted> copy(pq);
+	if (copies != N) return false;
+	for (int i = N - 1; i >= 0; i--) {
+		if (copy.top().v != i) return false;
+		copy.pop();
+	}
+	return copy.empty();
+}
+
+int main()
+{
+	std::cout << (testdeep() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testpool() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testshared() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "priority_queue.hpp"
+
+int rand() {
+	static unsigned reed = 1727417277;
+	reed = reed * 1103515245u + 12345u;
+	return (int) (reed >> 1);
+}
+
+const int SHARDS = 300;
+
+template<class Policy>
+bool testmergeall()
+{
+	typedef sjtu::priority_queue<int, std::less<int>, Policy> queue;
+	std::vector<queue> shards(SHARDS);
+	std::vector<int> all;
+	for (int i = 0; i < SHARDS; i++) {
+		int n = rand() % 2000;
+		for (int j = 0; j < n; j++) {
+			int x = rand();
+			shards[i].push(x);
+			all.push_back(x);
+		}
+	}
+
+	//不合并,按顺序读出所有分片和两个有序数组
+	std::vector<int> sorted_a, sorted_b;
+	for (int i = 0; i < 5000; i++) {
+		sorted_a.push_back(rand());
+		sorted_b.push_back(rand() % 100);
+	}
+	std::sort(sorted_a.begin(), sorted_a.end(), std::greater<int>());
+	std::sort(sorted_b.begin(), sorted_b.end(), std::greater<int>());
+	sjtu::kway_merge<int, std::less<int>, Policy> stream;
+	for (int i = 0; i < SHARDS; i++) stream.add(shards[i]);
+	stream.add(sorted_a.data(), sorted_a.data() + sorted_a.size());
+	stream.add(sorted_b.data(), sorted_b.data() + sorted_b.size());
+	std::vector<int> expect(all);
+	expect.insert(expect.end(), sorted_a.begin(), sorted_a.end());
+	expect.insert(expect.end(), sorted_b.begin(), sorted_b.end());
+	std::sort(expect.begin(), expect.end(), std::greater<int>());
+	for (size_t i = 0; i < expect.size(); i++) {
+		if (stream.empty() || stream.top() != expect[i]) return false;
+		stream.pop();
+	}
+	if (!stream.empty()) return false;
+
+	queue result;
+	result.push(-1);
+	all.push_back(-1);
+	result.merge_all(shards.begin(), shards.end());
+	for (int i = 0; i < SHARDS; i++)
+		if (!shards[i].empty()) return false;
+	std::sort(all.begin(), all.end(), std::greater<int>());
+	if (result.size() != all.size()) return false;
+	for (size_t i = 0; i < all.size(); i++) {
+		if (result.top() != all[i]) return false;
+		result.pop();
+	}
+	return result.empty();
+}
+
+int main()
+{
+	std::cout << (testmergeall<sjtu::skew_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testmergeall<sjtu::leftist_heap>() ? "OKAY" : "FAIL") << std::endl;
+	std::cout << (testmergeall<sjtu::binomial_heap>() ? "OKAY" : "FAIL") << std::endl;
+	return 0;
+}
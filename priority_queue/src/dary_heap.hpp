@@ -0,0 +1,313 @@
+#ifndef SJTU_DARY_HEAP_HPP
+#define SJTU_DARY_HEAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//用-mavx2编译时直接用AVX2找最大的儿子。
+//没有-mavx2时可以在include之前定义SJTU_DARY_FORCE_AVX2(只支持GCC/Clang),
+//这时只有下面几个选儿子的函数按avx2编译,调用方要自己保证CPU支持AVX2
+#if defined(__AVX2__)
+#define SJTU_DARY_AVX2 1
+#define SJTU_DARY_AVX2_TARGET
+#elif defined(SJTU_DARY_FORCE_AVX2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SJTU_DARY_AVX2 1
+#define SJTU_DARY_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef SJTU_DARY_AVX2
+#include <immintrin.h>
+#endif
+
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+    //在连续的cnt(<=8)个儿子中找最大的,相等时取下标最小的
+    template<typename T, class Compare>
+    int dary_best_scalar(const T *g, int cnt, const Compare &comp = Compare()) {
+        int b = 0;
+        for (int i = 1; i < cnt; i++)
+            if (comp(g[b], g[i])) b = i;
+        return b;
+    }
+
+    //向量版本只有std::less,它没有状态,所以不需要传入的比较器
+    template<typename T, class Compare>
+    struct dary_select {
+        static int best(const T *g, int cnt, const Compare &comp = Compare()) {
+            return dary_best_scalar<T, Compare>(g, cnt, comp);
+        }
+    };
+
+#ifdef SJTU_DARY_AVX2
+    //满的一组8个儿子:一次比较归约求出最大值,再用掩码找到它的下标
+    template<>
+    struct dary_select<int, std::less<int> > {
+        SJTU_DARY_AVX2_TARGET static int best(const int *g, int cnt, const std::less<int> & = std::less<int>()) {
+            if (cnt < 8) return dary_best_scalar<int, std::less<int> >(g, cnt);
+            __m256i v = _mm256_loadu_si256((const __m256i *) g);
+            __m256i m = _mm256_max_epi32(v, _mm256_permute2x128_si256(v, v, 1));
+            m = _mm256_max_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+            m = _mm256_max_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m)));
+            return __builtin_ctz(mask);
+        }
+    };
+
+    template<>
+    struct dary_select<long long, std::less<long long> > {
+        SJTU_DARY_AVX2_TARGET static __m256i max_epi64(__m256i a, __m256i b) {
+            return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a));
+        }
+
+        SJTU_DARY_AVX2_TARGET static int best(const long long *g, int cnt,
+                                                const std::less<long long> & = std::less<long long>()) {
+            if (cnt < 8) return dary_best_scalar<long long, std::less<long long> >(g, cnt);
+            __m256i lo = _mm256_loadu_si256((const __m256i *) g);
+            __m256i hi = _mm256_loadu_si256((const __m256i *) (g + 4));
+            __m256i m = max_epi64(lo, hi);
+            m = max_epi64(m, _mm256_permute4x64_epi64(m, _MM_SHUFFLE(1, 0, 3, 2)));
+            m = max_epi64(m, _mm256_permute4x64_epi64(m, _MM_SHUFFLE(2, 3, 0, 1)));
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lo, m))) |
+                       _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hi, m))) << 4;
+            return __builtin_ctz(mask);
+        }
+    };
+
+    template<>
+    struct dary_select<double, std::less<double> > {
+        SJTU_DARY_AVX2_TARGET static int best(const double *g, int cnt,
+                                                const std::less<double> & = std::less<double>()) {
+            if (cnt < 8) return dary_best_scalar<double, std::less<double> >(g, cnt);
+            __m256d lo = _mm256_loadu_pd(g), hi = _mm256_loadu_pd(g + 4);
+            __m256d m = _mm256_max_pd(lo, hi);
+            m = _mm256_max_pd(m, _mm256_permute2f128_pd(m, m, 1));
+            m = _mm256_max_pd(m, _mm256_permute_pd(m, 5));
+            int mask = _mm256_movemask_pd(_mm256_cmp_pd(lo, m, _CMP_EQ_OQ)) |
+                       _mm256_movemask_pd(_mm256_cmp_pd(hi, m, _CMP_EQ_OQ)) << 4;
+            //有NaN时没有严格弱序,退回逐个比较
+            if (mask == 0) return dary_best_scalar<double, std::less<double> >(g, cnt);
+            return __builtin_ctz(mask);
+        }
+    };
+#endif
+
+/**
+ * an implicit 8-ary max-heap on a contiguous array.
+ * the 8 children of a node are adjacent and start at a 64-byte aligned slot,
+ * so one level costs one cache line for 8-byte keys (half of one for int).
+ * for int, long long and double with std::less the best child is found with
+ * AVX2 when compiled with -mavx2 (or with SJTU_DARY_FORCE_AVX2 defined on a
+ * CPU known to support it), otherwise by a scalar loop.
+ * unlike priority_queue, merge moves elements and is not O(log n).
+ */
+    template<typename T, class Compare = std::less<T> >
+    class dary_heap : private compare_holder<Compare> {
+        enum { D = 8 };
+
+        typedef compare_holder<Compare> compare_base;
+        using compare_base::comp;
+
+    private:
+        void *raw;  //申请到的原始内存
+        T *a;       //a[i]是第i个节点,儿子是a[8i+1..8i+8],a前面空出7个位置用来对齐
+        size_t len, cap;
+
+    public:
+        dary_heap() : raw(nullptr), a(nullptr), len(0), cap(0) {}
+
+        //用比较器c的一份拷贝来比较元素
+        explicit dary_heap(const Compare &c) : compare_base(c), raw(nullptr), a(nullptr), len(0), cap(0) {}
+
+        dary_heap(const dary_heap &other) : compare_base(other), raw(nullptr), a(nullptr), len(0), cap(0) {
+            reserve(other.len);
+            for (; len < other.len; len++) new(a + len) T(other.a[len]);
+        }
+
+        dary_heap(dary_heap &&other) noexcept(std::is_nothrow_copy_constructible<Compare>::value)
+                : compare_base(other), raw(other.raw), a(other.a), len(other.len), cap(other.cap) {
+            other.raw = nullptr;
+            other.a = nullptr;
+            other.len = other.cap = 0;
+        }
+
+        ~dary_heap() {
+            clear();
+            ::operator delete(raw);
+        }
+
+        dary_heap &operator=(const dary_heap &other) {
+            if (this == &other) return *this;
+            clear();
+            compare_base::operator=(other);
+            reserve(other.len);
+            for (; len < other.len; len++) new(a + len) T(other.a[len]);
+            return *this;
+        }
+
+        dary_heap &operator=(dary_heap &&other) noexcept(std::is_nothrow_copy_assignable<Compare>::value) {
+            if (this == &other) return *this;
+            compare_base::operator=(other);
+            clear();
+            ::operator delete(raw);
+            raw = other.raw;
+            a = other.a;
+            len = other.len;
+            cap = other.cap;
+            other.raw = nullptr;
+            other.a = nullptr;
+            other.len = other.cap = 0;
+            return *this;
+        }
+
+        /**
+         * a copy of the comparator used by this heap.
+         */
+        Compare value_comp() const {
+            return comp();
+        }
+
+        /**
+         * get the top of the queue.
+         * throw container_is_empty if empty() returns true;
+         */
+        const T &top() const {
+            if (empty()) throw container_is_empty();
+            return a[0];
+        }
+
+        void push(const T &e) {
+            if (len == cap) reserve(cap ? cap * 2 : 64);
+            new(a + len) T(e);
+            sift_up(len++);
+        }
+
+        void push(T &&e) {
+            if (len == cap) reserve(cap ? cap * 2 : 64);
+            new(a + len) T(std::move(e));
+            sift_up(len++);
+        }
+
+        template<class... Args>
+        void emplace(Args &&...args) {
+            if (len == cap) reserve(cap ? cap * 2 : 64);
+            new(a + len) T(std::forward<Args>(args)...);
+            sift_up(len++);
+        }
+
+        /**
+         * delete the top element.
+         * throw container_is_empty if empty() returns true;
+         */
+        void pop() {
+            if (empty()) throw container_is_empty();
+            if (--len) a[0] = std::move(a[len]);
+            a[len].~T();
+            if (len) sift_down(0);
+        }
+
+        /**
+         * move the top element out and delete it.
+         * throw container_is_empty if empty() returns true;
+         */
+        T pop_top() {
+            if (empty()) throw container_is_empty();
+            T res(std::move(a[0]));
+            if (--len) a[0] = std::move(a[len]);
+            a[len].~T();
+            if (len) sift_down(0);
+            return res;
+        }
+
+        size_t size() const {
+            return len;
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        /**
+         * move all elements of other into this heap and clear other.
+         * a big other is appended and the whole array is rebuilt in O(n + m),
+         * a small one is pushed one by one in O(m log(n + m)).
+         */
+        void merge(dary_heap &other) {
+            if (this == &other) return;
+            size_t m = other.len, old = len;
+            reserve(len + m);
+            for (size_t i = 0; i < m; i++) new(a + len + i) T(std::move(other.a[i]));
+            other.clear();
+            len += m;
+            if (m * 8 >= old) {
+                for (size_t i = len / D + 1; i-- > 0;) sift_down(i);
+            } else {
+                for (size_t i = old; i < len; i++) sift_up(i);
+            }
+        }
+
+        void clear() {
+            for (size_t i = 0; i < len; i++) a[i].~T();
+            len = 0;
+        }
+
+        void reserve(size_t n) {
+            if (n <= cap) return;
+            //多申请64字节用来对齐,再多D-1个位置放在a前面
+            void *tmp_raw = ::operator new((n + D - 1) * sizeof(T) + 64);
+            T *tmp = reinterpret_cast<T *>((reinterpret_cast<uintptr_t>(tmp_raw) + 63) & ~(uintptr_t) 63) + (D - 1);
+            for (size_t i = 0; i < len; i++) {
+                new(tmp + i) T(std::move(a[i]));
+                a[i].~T();
+            }
+            ::operator delete(raw);
+            raw = tmp_raw;
+            a = tmp;
+            cap = n;
+        }
+
+    private:
+        void sift_up(size_t i) {
+            if (i == 0) return;
+            T x(std::move(a[i]));
+            while (i) {
+                size_t p = (i - 1) / D;
+                if (!comp()(a[p], x)) break;
+                a[i] = std::move(a[p]);
+                i = p;
+            }
+            a[i] = std::move(x);
+        }
+
+        void sift_down(size_t i) {
+            if (i * D + 1 >= len) return;
+            T x(std::move(a[i]));
+            while (i * D + 1 < len) {
+                size_t c = i * D + 1, cnt = len - c < (size_t) D ? len - c : (size_t) D;
+                c += dary_select<T, Compare>::best(a + c, (int) cnt, comp());
+                if (!comp()(x, a[c])) break;
+                a[i] = std::move(a[c]);
+                i = c;
+            }
+            a[i] = std::move(x);
+        }
+    };
+
+/**
+ * dary_heap for arithmetic keys ordered by std::less, priority_queue otherwise.
+ * use it only when merge is rare: dary_heap::merge is not O(log n).
+ */
+    template<typename T, class Compare = std::less<T> >
+    using fast_priority_queue = typename std::conditional<
+            std::is_arithmetic<T>::value && std::is_same<Compare, std::less<T> >::value,
+            dary_heap<T, Compare>, priority_queue<T, Compare> >::type;
+
+}
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef SJTU_EXTERNAL_PRIORITY_QUEUE_HPP
+#define SJTU_EXTERNAL_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * a priority queue which spills to disk when it grows beyond a memory budget.
+ * new elements go to an in-memory priority_queue; when it is full, it is
+ * written out as a sorted run to a temporary file. top/pop take the best of
+ * the in-memory heap and the buffered heads of the runs. when there are more
+ * runs than read buffers fit in the budget, all runs are merged into one.
+ * T is written byte by byte, so it must be trivially copyable.
+ */
+    template<typename T, class Compare = std::less<T> >
+    class external_priority_queue : private compare_holder<Compare> {
+        static_assert(std::is_trivially_copyable<T>::value, "external_priority_queue needs a trivially copyable T");
+
+        //一个已经排好序(从大到小)的外存段,buf中缓存接下来的若干个元素
+        struct Run {
+            FILE *file;
+            T *buf;
+            size_t pos, cnt; //buf[pos, cnt)还没有被取走
+            size_t remain;   //文件中还没有读进buf的元素个数
+
+            Run() : file(nullptr), buf(nullptr), pos(0), cnt(0), remain(0) {}
+
+            ~Run() {
+                if (file) fclose(file);
+                ::operator delete(buf);
+            }
+        };
+
+        typedef compare_holder<Compare> compare_base;
+        using compare_base::comp;
+
+    private:
+        priority_queue<T, Compare> heap;
+        Run **runs; //按段首元素组织成大根堆, runs[0]的段首最大
+        int run_cnt, run_cap;
+        size_t len;
+
+        size_t heap_limit;  //内存中最多保存的元素个数
+        size_t block;       //每个段的缓冲区能放下的元素个数
+        int max_runs;       //缓冲区数量的上限,超过就把所有段合并成一段
+        size_t written, read;
+
+    public:
+        /**
+         * memory_budget: bytes for the in-memory heap and the run buffers, half each.
+         * block_bytes: size of one read/write buffer.
+         * c: the comparator, a copy of it is also used by the in-memory heap.
+         */
+        explicit external_priority_queue(size_t memory_budget = 64u << 20, size_t block_bytes = 1u << 16,
+                                         const Compare &c = Compare())
+                : compare_base(c), heap(c), runs(nullptr), run_cnt(0), run_cap(0), len(0), written(0), read(0) {
+            block = block_bytes / sizeof(T);
+            if (block == 0) block = 1;
+            heap_limit = memory_budget / 2 / decltype(heap)::node_size;
+            if (heap_limit == 0) heap_limit = 1;
+            //留一个缓冲区给合并时的输出段
+            max_runs = (int) (memory_budget / 2 / (block * sizeof(T))) - 1;
+            if (max_runs < 2) max_runs = 2;
+        }
+
+        external_priority_queue(const external_priority_queue &other) = delete;
+
+        external_priority_queue &operator=(const external_priority_queue &other) = delete;
+
+        ~external_priority_queue() {
+            for (int i = 0; i < run_cnt; i++) delete runs[i];
+            delete[] runs;
+        }
+
+        /**
+         * a copy of the comparator used by this queue.
+         */
+        Compare value_comp() const {
+            return comp();
+        }
+
+        /**
+         * get the top of the queue.
+         * throw container_is_empty if empty() returns true;
+         */
+        const T &top() const {
+            if (empty()) throw container_is_empty();
+            if (from_heap()) return heap.top();
+            return head(runs[0]);
+        }
+
+        /**
+         * push new element, the in-memory heap is spilled to disk if it is full.
+         */
+        void push(const T &e) {
+            if (heap.size() >= heap_limit) spill();
+            heap.push(e);
+            len++;
+        }
+
+        /**
+         * delete the top element.
+         * throw container_is_empty if empty() returns true;
+         */
+        void pop() {
+            if (empty()) throw container_is_empty();
+            if (from_heap()) heap.pop();
+            else advance();
+            len--;
+        }
+
+        size_t size() const {
+            return len;
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        //I/O 统计
+        size_t bytes_written() const {
+            return written;
+        }
+
+        size_t bytes_read() const {
+            return read;
+        }
+
+        int run_count() const {
+            return run_cnt;
+        }
+
+    private:
+        static const T &head(const Run *r) {
+            return r->buf[r->pos];
+        }
+
+        //runs[i]的段首比runs[j]的更大
+        bool better(int i, int j) const {
+            return comp()(head(runs[j]), head(runs[i]));
+        }
+
+        bool from_heap() const {
+            if (run_cnt == 0) return true;
+            if (heap.empty()) return false;
+            return !comp()(heap.top(), head(runs[0]));
+        }
+
+        void sift_up(int i) {
+            while (i && better(i, (i - 1) / 2)) {
+                swap<Run *>(runs[i], runs[(i - 1) / 2]);
+                i = (i - 1) / 2;
+            }
+        }
+
+        void sift_down(int i) {
+            while (1) {
+                int best = i, l = i * 2 + 1, r = i * 2 + 2;
+                if (l < run_cnt && better(l, best)) best = l;
+                if (r < run_cnt && better(r, best)) best = r;
+                if (best == i) return;
+                swap<Run *>(runs[i], runs[best]);
+                i = best;
+            }
+        }
+
+        //保证runs中还能再放一个段
+        void reserve_run() {
+            if (run_cnt < run_cap) return;
+            int cap = run_cap ? run_cap * 2 : 8;
+            Run **tmp = new Run *[cap];
+            for (int i = 0; i < run_cnt; i++) tmp[i] = runs[i];
+            delete[] runs;
+            runs = tmp;
+            run_cap = cap;
+        }
+
+        void add_run(Run *r) {
+            reserve_run();
+            runs[run_cnt] = r;
+            sift_up(run_cnt++);
+        }
+
+        //runs[0]不再放在堆里,由调用者负责释放
+        Run *remove_top_run() {
+            Run *r = runs[0];
+            runs[0] = runs[--run_cnt];
+            if (run_cnt) sift_down(0);
+            return r;
+        }
+
+        Run *new_run() {
+            Run *r = new Run;
+            r->file = tmpfile();
+            if (r->file == nullptr) {
+                delete r;
+                throw runtime_error();
+            }
+            //buf已经是整块读写了,不再经过stdio的缓冲,fwrite返回时就知道有没有写成功
+            setvbuf(r->file, nullptr, _IONBF, 0);
+            //T不一定有默认构造函数,只申请原始内存
+            r->buf = static_cast<T *>(::operator new(block * sizeof(T)));
+            return r;
+        }
+
+        //写缓冲区中的cnt个元素
+        void flush(Run *r) {
+            if (r->cnt == 0) return;
+            if (fwrite(r->buf, sizeof(T), r->cnt, r->file) != r->cnt) throw runtime_error();
+            written += r->cnt * sizeof(T);
+            r->remain += r->cnt;
+            r->cnt = 0;
+        }
+
+        //缓冲区满了先写出去再放e,写失败时缓冲区里的元素都还在
+        void write(Run *r, const T &e) {
+            if (r->cnt == block) flush(r);
+            memcpy(r->buf + r->cnt++, &e, sizeof(T));
+        }
+
+        //读入下一块,文件读完就返回false
+        bool refill(Run *r) {
+            r->pos = 0;
+            r->cnt = r->remain < block ? r->remain : block;
+            if (r->cnt == 0) return false;
+            if (fread(r->buf, sizeof(T), r->cnt, r->file) != r->cnt) throw runtime_error();
+            read += r->cnt * sizeof(T);
+            r->remain -= r->cnt;
+            return true;
+        }
+
+        //写完之后回到文件开头,读入第一块,放进runs;调用前runs中要留好位置。空的段直接删掉
+        void open_run(Run *r) {
+            rewind(r->file);
+            try {
+                if (!refill(r)) {
+                    delete r;
+                    return;
+                }
+            } catch (...) {
+                //文件读不出来,里面的元素只能丢掉
+                len -= r->remain;
+                delete r;
+                throw;
+            }
+            add_run(r);
+        }
+
+        //写段失败后:文件里已经写好的r->remain个元素仍然是一个有序段,缓冲区里的放回内存中的堆
+        void salvage(Run *r) {
+            try {
+                for (; r->cnt; r->cnt--) heap.push(r->buf[r->cnt - 1]);
+            } catch (...) {
+                len -= r->cnt;
+                r->cnt = 0;
+                open_run(r);
+                throw;
+            }
+            open_run(r);
+        }
+
+        //把内存中的堆按顺序写成一个新的段,先写再从堆里删掉
+        void spill() {
+            reserve_run();
+            Run *r = new_run();
+            try {
+                while (!heap.empty()) {
+                    write(r, heap.top());
+                    heap.pop();
+                }
+                flush(r);
+            } catch (...) {
+                salvage(r);
+                throw;
+            }
+            open_run(r);
+            if (run_cnt > max_runs) merge_runs();
+        }
+
+        //多路归并所有段,写失败时已经归并出的部分成为一个新的段
+        void merge_runs() {
+            reserve_run();
+            Run *out = new_run();
+            try {
+                while (run_cnt) {
+                    write(out, head(runs[0]));
+                    advance();
+                }
+                flush(out);
+            } catch (...) {
+                salvage(out);
+                throw;
+            }
+            open_run(out);
+        }
+
+        //取走runs[0]的段首
+        void advance() {
+            Run *r = runs[0];
+            if (++r->pos < r->cnt || refill(r)) sift_down(0);
+            else delete remove_top_run();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef SJTU_MINMAX_HEAP_HPP
+#define SJTU_MINMAX_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * a double-ended priority queue (min-max heap) on a contiguous array.
+ * even levels (the root is level 0) are min levels: a node there is no greater
+ * than anything in its subtree; odd levels are max levels.
+ * push/pop_min/pop_max are O(log n), top_min/top_max are O(1).
+ */
+    template<typename T, class Compare = std::less<T> >
+    class minmax_heap : private compare_holder<Compare> {
+        typedef compare_holder<Compare> compare_base;
+        using compare_base::comp;
+
+    private:
+        T *a; //原始内存,只有[0, len)中的元素被构造过
+        size_t len, cap;
+
+    public:
+        minmax_heap() : a(nullptr), len(0), cap(0) {}
+
+        //用比较器c的一份拷贝来比较元素
+        explicit minmax_heap(const Compare &c) : compare_base(c), a(nullptr), len(0), cap(0) {}
+
+        minmax_heap(const minmax_heap &other) : compare_base(other), a(nullptr), len(0), cap(0) {
+            reserve(other.len);
+            for (; len < other.len; len++) new(a + len) T(other.a[len]);
+        }
+
+        minmax_heap(minmax_heap &&other) noexcept(std::is_nothrow_copy_constructible<Compare>::value)
+                : compare_base(other), a(other.a), len(other.len), cap(other.cap) {
+            other.a = nullptr;
+            other.len = other.cap = 0;
+        }
+
+        ~minmax_heap() {
+            clear();
+            ::operator delete(a);
+        }
+
+        minmax_heap &operator=(const minmax_heap &other) {
+            if (this == &other) return *this;
+            clear();
+            compare_base::operator=(other);
+            reserve(other.len);
+            for (; len < other.len; len++) new(a + len) T(other.a[len]);
+            return *this;
+        }
+
+        minmax_heap &operator=(minmax_heap &&other) noexcept(std::is_nothrow_copy_assignable<Compare>::value) {
+            if (this == &other) return *this;
+            compare_base::operator=(other);
+            clear();
+            ::operator delete(a);
+            a = other.a;
+            len = other.len;
+            cap = other.cap;
+            other.a = nullptr;
+            other.len = other.cap = 0;
+            return *this;
+        }
+
+        /**
+         * a copy of the comparator used by this heap.
+         */
+        Compare value_comp() const {
+            return comp();
+        }
+
+        /**
+         * the smallest element.
+         * throw container_is_empty if empty() returns true;
+         */
+        const T &top_min() const {
+            if (empty()) throw container_is_empty();
+            return a[0];
+        }
+
+        /**
+         * the largest element.
+         * throw container_is_empty if empty() returns true;
+         */
+        const T &top_max() const {
+            if (empty()) throw container_is_empty();
+            return a[max_index()];
+        }
+
+        void push(const T &e) {
+            if (len == cap) reserve(cap ? cap * 2 : 16);
+            new(a + len) T(e);
+            bubble_up(len++);
+        }
+
+        void push(T &&e) {
+            if (len == cap) reserve(cap ? cap * 2 : 16);
+            new(a + len) T(std::move(e));
+            bubble_up(len++);
+        }
+
+        /**
+         * delete the smallest element.
+         * throw container_is_empty if empty() returns true;
+         */
+        void pop_min() {
+            if (empty()) throw container_is_empty();
+            erase_at(0);
+        }
+
+        /**
+         * delete the largest element.
+         * throw container_is_empty if empty() returns true;
+         */
+        void pop_max() {
+            if (empty()) throw container_is_empty();
+            erase_at(max_index());
+        }
+
+        size_t size() const {
+            return len;
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        void clear() {
+            for (size_t i = 0; i < len; i++) a[i].~T();
+            len = 0;
+        }
+
+        void reserve(size_t n) {
+            if (n <= cap) return;
+            T *tmp = static_cast<T *>(::operator new(n * sizeof(T)));
+            for (size_t i = 0; i < len; i++) {
+                new(tmp + i) T(std::move(a[i]));
+                a[i].~T();
+            }
+            ::operator delete(a);
+            a = tmp;
+            cap = n;
+        }
+
+    private:
+        //第i个位置在最小层
+        static bool min_level(size_t i) {
+            int depth = 0;
+            for (i++; i > 1; i >>= 1) depth++;
+            return !(depth & 1);
+        }
+
+        //在最小层时比较<,在最大层时比较>
+        bool better(size_t i, size_t j, bool is_min) const {
+            return is_min ? comp()(a[i], a[j]) : comp()(a[j], a[i]);
+        }
+
+        size_t max_index() const {
+            if (len == 1) return 0;
+            if (len == 2 || comp()(a[2], a[1])) return 1;
+            return 2;
+        }
+
+        //用最后一个元素填到位置i,再向下调整
+        void erase_at(size_t i) {
+            len--;
+            if (i != len) a[i] = std::move(a[len]);
+            a[len].~T();
+            if (i < len) trickle_down(i);
+        }
+
+        void bubble_up(size_t i) {
+            if (i == 0) return;
+            size_t p = (i - 1) / 2;
+            bool is_min = min_level(i);
+            //和父亲在相反的层,不满足父亲那一层的性质就交换过去
+            if (better(p, i, is_min)) {
+                std::swap(a[i], a[p]);
+                bubble_up_grand(p, !is_min);
+            } else {
+                bubble_up_grand(i, is_min);
+            }
+        }
+
+        //只和同一类层的祖父比较
+        void bubble_up_grand(size_t i, bool is_min) {
+            while (i > 2) {
+                size_t gp = ((i - 1) / 2 - 1) / 2;
+                if (!better(i, gp, is_min)) return;
+                std::swap(a[i], a[gp]);
+                i = gp;
+            }
+        }
+
+        void trickle_down(size_t i) {
+            bool is_min = min_level(i);
+            while (i * 2 + 1 < len) {
+                //在儿子和孙子中找最好的m
+                size_t m = i * 2 + 1;
+                for (size_t c = i * 2 + 1; c <= i * 2 + 2 && c < len; c++) {
+                    if (better(c, m, is_min)) m = c;
+                    for (size_t g = c * 2 + 1; g <= c * 2 + 2 && g < len; g++)
+                        if (better(g, m, is_min)) m = g;
+                }
+                if (!better(m, i, is_min)) return;
+                std::swap(a[m], a[i]);
+                if (m <= i * 2 + 2) return; //m是儿子,交换之后就满足性质了
+                size_t p = (m - 1) / 2;
+                if (better(p, m, is_min)) std::swap(a[m], a[p]);
+                i = m;
+            }
+        }
+    };
+
+}
+
+#endif
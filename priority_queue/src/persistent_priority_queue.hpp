@@ -0,0 +1,223 @@
+#ifndef SJTU_PERSISTENT_PRIORITY_QUEUE_HPP
+#define SJTU_PERSISTENT_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * a persistent priority queue: copies share all nodes and cost O(1),
+ * push/pop/merge copy only the right spine they touch, O(log n) each.
+ * implemented by a leftist heap with reference-counted nodes.
+ * the counters are not atomic, so versions sharing nodes must stay in one thread.
+ */
+    template<typename T, class Compare = std::less<T> >
+    class persistent_priority_queue : private compare_holder<Compare> {
+        typedef compare_holder<Compare> compare_base;
+        using compare_base::comp;
+
+        //节点一旦被多个版本共享就不能再修改,只有 cnt == 1 的节点可以原地修改
+        struct Node {
+            T data;
+            Node *left, *right;
+            int rank; //零路径长度
+            int cnt;  //引用计数
+
+            template<class... Args>
+            explicit Node(Args &&...args) : data(std::forward<Args>(args)...), left(nullptr), right(nullptr),
+                                            rank(0), cnt(1) {}
+        };
+
+    private:
+        Node *root;
+        int len;
+
+    public:
+        persistent_priority_queue() : root(nullptr), len(0) {}
+
+        //用比较器c的一份拷贝来比较元素
+        explicit persistent_priority_queue(const Compare &c) : compare_base(c), root(nullptr), len(0) {}
+
+        //O(1),和other共享所有节点
+        persistent_priority_queue(const persistent_priority_queue &other)
+                : compare_base(other), root(retain(other.root)), len(other.len) {}
+
+        persistent_priority_queue(persistent_priority_queue &&other) noexcept(
+                std::is_nothrow_copy_constructible<Compare>::value)
+                : compare_base(other), root(other.root), len(other.len) {
+            other.root = nullptr;
+            other.len = 0;
+        }
+
+        ~persistent_priority_queue() {
+            release(root);
+        }
+
+        persistent_priority_queue &operator=(const persistent_priority_queue &other) {
+            //先retain再release,自身赋值也不会提前删除
+            compare_base::operator=(other);
+            Node *t = retain(other.root);
+            release(root);
+            root = t;
+            len = other.len;
+            return *this;
+        }
+
+        persistent_priority_queue &operator=(persistent_priority_queue &&other) noexcept(
+                std::is_nothrow_copy_assignable<Compare>::value) {
+            if (this == &other) return *this;
+            compare_base::operator=(other);
+            release(root);
+            root = other.root;
+            len = other.len;
+            other.root = nullptr;
+            other.len = 0;
+            return *this;
+        }
+
+        /**
+         * a copy of the comparator used by this queue.
+         */
+        Compare value_comp() const {
+            return comp();
+        }
+
+        /**
+         * get the top of the queue.
+         * throw container_is_empty if empty() returns true;
+         */
+        const T &top() const {
+            if (empty()) throw container_is_empty();
+            return root->data;
+        }
+
+        void push(const T &e) {
+            root = merge_node(root, new Node(e));
+            len++;
+        }
+
+        void push(T &&e) {
+            root = merge_node(root, new Node(std::move(e)));
+            len++;
+        }
+
+        template<class... Args>
+        void emplace(Args &&...args) {
+            root = merge_node(root, new Node(std::forward<Args>(args)...));
+            len++;
+        }
+
+        /**
+         * delete the top element, other versions are not affected.
+         * throw container_is_empty if empty() returns true;
+         */
+        void pop() {
+            if (empty()) throw container_is_empty();
+            Node *t = root, *l = retain(t->left), *r = retain(t->right);
+            release(t);
+            root = merge_node(l, r);
+            len--;
+        }
+
+        size_t size() const {
+            return len;
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        /**
+         * merge other into this queue in O(log n).
+         * unlike priority_queue::merge, other keeps its elements since the nodes are shared.
+         */
+        void merge(const persistent_priority_queue &other) {
+            root = merge_node(root, retain(other.root));
+            len += other.len;
+        }
+
+        void clear() {
+            release(root);
+            root = nullptr;
+            len = 0;
+        }
+
+    private:
+        static int npl(const Node *t) {
+            return t ? t->rank : -1;
+        }
+
+        static Node *retain(Node *t) {
+            if (t) t->cnt++;
+            return t;
+        }
+
+        //引用计数归零的节点才真正删除
+        //左偏树的左链可以很长,用显式栈代替递归
+        static void release(Node *t) {
+            if (t == nullptr || --t->cnt) return;
+            int cap = 64, top = 0;
+            Node **stack = new Node *[cap];
+            stack[top++] = t;
+            while (top) {
+                Node *x = stack[--top], *ch[2] = {x->left, x->right};
+                delete x;
+                for (int i = 0; i < 2; i++) {
+                    if (ch[i] == nullptr || --ch[i]->cnt) continue;
+                    if (top == cap) {
+                        Node **tmp = new Node *[cap * 2];
+                        for (int j = 0; j < top; j++) tmp[j] = stack[j];
+                        delete[] stack;
+                        stack = tmp;
+                        cap *= 2;
+                    }
+                    stack[top++] = ch[i];
+                }
+            }
+            delete[] stack;
+        }
+
+        //得到一个可以修改的t: 独占就直接用,共享就复制一份(儿子仍然共享)
+        static Node *own(Node *t) {
+            if (t->cnt == 1) return t;
+            Node *res = new Node(t->data);
+            res->left = retain(t->left);
+            res->right = retain(t->right);
+            res->rank = t->rank;
+            t->cnt--;
+            return res;
+        }
+
+        //合并x和y,消耗调用者持有的x,y各一个引用,返回新根的一个引用
+        //只复制右链上被共享的节点
+        Node *merge_node(Node *x, Node *y) {
+            if (x == nullptr) return y;
+            if (y == nullptr) return x;
+
+            Node *tmp;
+            if (comp()(x->data, y->data)) {
+                tmp = x;
+                x = y;
+                y = tmp;
+            }
+            x = own(x);
+            x->right = merge_node(x->right, y);
+            if (npl(x->left) < npl(x->right)) {
+                tmp = x->left;
+                x->left = x->right;
+                x->right = tmp;
+            }
+            x->rank = npl(x->right) + 1;
+            return x;
+        }
+    };
+
+}
+
+#endif
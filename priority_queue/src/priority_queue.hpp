@@ -7,6 +7,13 @@
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <atomic>
+#include <exception>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 #include "exceptions.hpp"
 
@@ -22,37 +29,348 @@ namespace sjtu {
         b = p;
     }
 
-    //要写大根堆,用斜堆实现
-    template<typename T, class Compare = std::less<T> >
-    class priority_queue {
+    /**
+     * policies of the meldable heap inside priority_queue.
+     * skew_heap:     amortized O(log n), nodes carry no rank field (default).
+     * leftist_heap:  worst-case O(log n) push/pop/merge, rank is the null path length.
+     * binomial_heap: worst-case O(log n) push/pop/merge/top, rank is the degree.
+     */
+    struct skew_heap {};
+    struct leftist_heap {};
+    struct binomial_heap {};
 
-        struct Node {
+    /**
+     * instrumented<P> is the heap policy P which also records heap_stats,
+     * e.g. priority_queue<int, std::less<int>, instrumented<skew_heap> >.
+     * without it nothing is recorded and the queue does not grow.
+     */
+    template<class Policy>
+    struct instrumented {};
+
+    template<class Policy>
+    struct heap_policy {
+        typedef Policy type;
+        static const bool stats = false;
+    };
+
+    template<class Policy>
+    struct heap_policy<instrumented<Policy> > {
+        typedef Policy type;
+        static const bool stats = true;
+    };
+
+    /**
+     * counters of an instrumented priority_queue, see priority_queue::stats().
+     * path[0] counts merges that visit no node, path[i] those visiting
+     * [2^(i-1), 2^i) nodes; a skew heap going bad shows up as a heavy tail.
+     * right spine: the right path of a skew/leftist heap, the root list of a
+     * binomial heap, measured after every push/pop/merge once its time is
+     * taken (the walk is O(n) on a skew heap that went bad).
+     */
+    struct heap_stats {
+        enum { BUCKETS = 32 };
+        enum { PUSH, POP, MERGE, OPS };
+
+        unsigned long long merges;          //合并的次数,包括push/pop内部的
+        unsigned long long path[BUCKETS];   //一次合并走过的节点数的直方图
+        unsigned long long max_path;
+        unsigned long long allocations, frees;
+        unsigned long long max_right_spine;
+        unsigned long long ops[OPS];        //push/pop/merge各调用了多少次
+        unsigned long long ns[OPS];         //各自花的总时间(纳秒)
+
+        heap_stats() {
+            memset(this, 0, sizeof(heap_stats));
+        }
+    };
+
+    template<typename T, class Compare, class Policy, class Iter>
+    class kway_merge;
+
+/**
+ * a slab pool for the nodes of priority_queues.
+ * nodes are carved from chunks that double in size and are recycled through
+ * a free list; the memory goes back to the system only all at once, by
+ * release() or the destructor.
+ * a queue gives its nodes back to the free list when it is destroyed; one
+ * that calls discard() instead skips that walk, but its slots are never
+ * reused until release(), so discard only queues whose pool is released soon.
+ * queues sharing a pool can be merged; the pool is not thread-safe.
+ */
+    template<class Node>
+    class node_pool {
+        union Slot {
+            Slot *next;
+            alignas(Node) unsigned char data[sizeof(Node)];
+        };
+
+        struct Chunk {
+            Chunk *next;
+            Slot *slots;
+        };
+
+    private:
+        Chunk *chunks;
+        Slot *free_list, *cur, *cur_end;
+        size_t next_size;
+
+    public:
+        node_pool() : chunks(nullptr), free_list(nullptr), cur(nullptr), cur_end(nullptr), next_size(64) {}
+
+        node_pool(const node_pool &other) = delete;
+
+        node_pool &operator=(const node_pool &other) = delete;
+
+        ~node_pool() {
+            release();
+        }
+
+        void *allocate() {
+            if (free_list) {
+                Slot *s = free_list;
+                free_list = s->next;
+                return s;
+            }
+            if (cur == cur_end) {
+                Chunk *c = new Chunk;
+                try {
+                    c->slots = new Slot[next_size];
+                } catch (...) {
+                    delete c;
+                    throw;
+                }
+                c->next = chunks;
+                chunks = c;
+                cur = c->slots;
+                cur_end = cur + next_size;
+                if (next_size < (1u << 16)) next_size *= 2;
+            }
+            return cur++;
+        }
+
+        void deallocate(void *p) {
+            Slot *s = static_cast<Slot *>(p);
+            s->next = free_list;
+            free_list = s;
+        }
+
+        //一次性释放所有的块,之前分配出去的节点全部失效
+        void release() {
+            while (chunks) {
+                Chunk *c = chunks;
+                chunks = c->next;
+                delete[] c->slots;
+                delete c;
+            }
+            free_list = cur = cur_end = nullptr;
+            next_size = 64;
+        }
+    };
+
+/**
+ * holds the comparator of a queue.
+ * an empty comparator (std::less, a functor without members) is kept as a
+ * base class and takes no space; anything else (a functor with state, a
+ * function pointer) is kept as a member.
+ */
+    template<class Compare, bool = std::is_empty<Compare>::value && !std::is_final<Compare>::value>
+    class compare_holder : private Compare {
+    public:
+        compare_holder() : Compare() {}
+
+        explicit compare_holder(const Compare &c) : Compare(c) {}
+
+        const Compare &comp() const {
+            return *this;
+        }
+    };
+
+    template<class Compare>
+    class compare_holder<Compare, false> {
+        Compare c;
+
+    public:
+        compare_holder() : c() {}
+
+        explicit compare_holder(const Compare &_c) : c(_c) {}
+
+        const Compare &comp() const {
+            return c;
+        }
+    };
+
+    //不统计时是空类,作为基类不占空间,所有记录的函数都是空的
+    template<bool Enabled>
+    class stats_holder {
+    public:
+        struct op_scope {
+            template<class Node>
+            op_scope(stats_holder &, int, Node *const &) {}
+        };
+
+        void stat_step() {}
+
+        void stat_merge_begin() {}
+
+        void stat_merge_end() {}
+
+        void stat_alloc() {}
+
+        void stat_free() {}
+    };
+
+    template<>
+    class stats_holder<true> {
+        heap_stats st;
+        unsigned long long steps; //当前这次合并走过的节点数
+
+    public:
+        stats_holder() : steps(0) {}
+
+        //析构时把这次操作的时间记到ops[op]上,再量一次操作结束后的右链
+        //斜堆的右链最坏有O(n)长,所以先停表再量,不算在操作的时间里
+        struct op_scope {
+            stats_holder &h;
+            int op;
+            const void *root; //指向队列的root
+            unsigned long long (*spine)(const void *);
+            std::chrono::steady_clock::time_point start;
+
+            template<class Node>
+            op_scope(stats_holder &_h, int _op, Node *const &_root)
+                    : h(_h), op(_op), root(&_root), spine(&right_spine<Node>),
+                      start(std::chrono::steady_clock::now()) {}
+
+            ~op_scope() {
+                h.st.ns[op] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+                h.st.ops[op]++;
+                unsigned long long s = spine(root);
+                if (s > h.st.max_right_spine) h.st.max_right_spine = s;
+            }
+        };
+
+        template<class Node>
+        static unsigned long long right_spine(const void *root) {
+            unsigned long long n = 0;
+            for (const Node *t = *static_cast<Node *const *>(root); t; t = t->right) n++;
+            return n;
+        }
+
+        void stat_step() {
+            steps++;
+        }
+
+        void stat_merge_begin() {
+            steps = 0;
+        }
+
+        void stat_merge_end() {
+            int b = 0;
+            while (b + 1 < heap_stats::BUCKETS && (steps >> b)) b++;
+            st.merges++;
+            st.path[b]++;
+            if (steps > st.max_path) st.max_path = steps;
+        }
+
+        void stat_alloc() {
+            st.allocations++;
+        }
+
+        void stat_free() {
+            st.frees++;
+        }
+
+        const heap_stats &stats() const {
+            return st;
+        }
+
+        void reset_stats() {
+            st = heap_stats();
+        }
+    };
+
+    //左偏树和二项堆的节点记录rank;斜堆用不到,是空基类,节点里不占空间
+    template<bool Enabled>
+    struct node_rank {};
+
+    template<>
+    struct node_rank<true> {
+        int rank;
+
+        node_rank() : rank(0) {}
+    };
+
+    //要写大根堆,默认用斜堆实现
+    //比较器只保存一份,没有状态时不占空间
+    template<typename T, class Compare = std::less<T>, class Policy = skew_heap>
+    class priority_queue : private compare_holder<Compare>, private stats_holder<heap_policy<Policy>::stats> {
+        template<typename, class, class, class> friend class kway_merge;
+
+        typedef compare_holder<Compare> compare_base;
+        using compare_base::comp;
+
+        //instrumented<P>按P实现
+        typedef typename heap_policy<Policy>::type base_policy;
+        typedef stats_holder<heap_policy<Policy>::stats> stats_base;
+        typedef typename stats_base::op_scope op_scope;
+
+        //三种堆共用一种节点:
+        //斜堆/左偏树中 left/right 是左右儿子;二项堆中 left 是第一个儿子, right 是兄弟(左儿子右兄弟)
+        typedef node_rank<!std::is_same<base_policy, skew_heap>::value> rank_base;
+
+        struct Node : rank_base {
             T data;
             Node *left, *right;
 
-            //默认构造
-            Node(T item, Node *l = nullptr, Node *r = nullptr) : left(l), right(r), data(item) {}
+            //直接用参数原地构造data,避免先传值再复制的两次拷贝
+            template<class... Args>
+            explicit Node(Args &&...args) : data(std::forward<Args>(args)...), left(nullptr), right(nullptr) {}
 
             //赋值构造
-            Node(const Node &p) : left(p.left), right(p.right), data(p.data) {}
+            Node(const Node &p) : rank_base(p), data(p.data), left(p.left), right(p.right) {}
 
             ~Node() {}
         };
 
+    public:
+        typedef node_pool<Node> pool_type;
+
+        //一个元素在堆里占的字节数(不含分配器的额外开销)
+        static const size_t node_size = sizeof(Node);
+
+        //节点数超过这个值且T可以平凡复制时,复制会分给多个线程完成
+        static const int parallel_threshold = 1 << 16;
+
     private:
         Node *root;
         int len;
+        pool_type *pool; //为空时用new/delete
 
     public:
         /**
          * TODO constructors
          */
-        priority_queue() : root(nullptr), len(0) {}
+        priority_queue() : root(nullptr), len(0), pool(nullptr) {}
 
-        priority_queue(const priority_queue &other) {
+        //用比较器c的一份拷贝来比较元素
+        explicit priority_queue(const Compare &c) : compare_base(c), root(nullptr), len(0), pool(nullptr) {}
+
+        //节点从p中分配,p要比这个队列活得更久
+        explicit priority_queue(pool_type &p, const Compare &c = Compare())
+                : compare_base(c), root(nullptr), len(0), pool(&p) {}
+
+        //复制出的队列和other共用同一个pool和比较器
+        priority_queue(const priority_queue &other) : compare_base(other), root(nullptr), len(0), pool(other.pool) {
             //if (this == &other) return;
-            clone(root, other.root);
-            len = other.len;
+            copy_from(other);
+        }
+
+        //直接接管other的节点
+        priority_queue(priority_queue &&other) noexcept(std::is_nothrow_copy_constructible<Compare>::value)
+                : compare_base(other), root(other.root), len(other.len), pool(other.pool) {
+            other.root = nullptr;
+            other.len = 0;
         }
 
         /**
@@ -69,12 +387,62 @@ namespace sjtu {
         priority_queue &operator=(const priority_queue &other) {
             if (this == &other) return *this;
             clear(root);
-//            len = 0;
-            clone(root, other.root);
+            len = 0;
+            compare_base::operator=(other);
+            copy_from(other);
+            return *this;
+        }
+
+        //pool不同的时候不能直接接管节点,只能复制
+        priority_queue &operator=(priority_queue &&other) {
+            if (this == &other) return *this;
+            if (pool != other.pool) {
+                *this = other;
+                other.clear(other.root);
+                other.len = 0;
+                return *this;
+            }
+            clear(root);
+            compare_base::operator=(other);
+            root = other.root;
             len = other.len;
+            other.root = nullptr;
+            other.len = 0;
             return *this;
         }
 
+        /**
+         * forget all elements without visiting their nodes, for a queue whose
+         * pool is about to be release()d. the slots are not given back to the
+         * free list. without a pool, or if T needs its destructor, this is the
+         * same as destroying the elements one by one.
+         */
+        void discard() {
+            if (pool && std::is_trivially_destructible<T>::value) root = nullptr;
+            else clear(root);
+            len = 0;
+        }
+
+        /**
+         * a copy of the comparator used by this queue.
+         */
+        Compare value_comp() const {
+            return comp();
+        }
+
+        /**
+         * a snapshot of the counters, only with an instrumented<...> policy.
+         */
+        heap_stats stats() const {
+            static_assert(heap_policy<Policy>::stats, "stats() needs an instrumented<...> policy");
+            return stats_base::stats();
+        }
+
+        void reset_stats() {
+            static_assert(heap_policy<Policy>::stats, "reset_stats() needs an instrumented<...> policy");
+            stats_base::reset_stats();
+        }
+
         /**
          * get the top of the queue.
          * @return a reference of the top element.
@@ -82,7 +450,7 @@ namespace sjtu {
          */
         const T &top() const {
             if (empty()) throw container_is_empty();
-            return root->data;
+            return find_top(root, base_policy())->data;
         }
 
         /**
@@ -91,7 +459,26 @@ namespace sjtu {
          */
         void push(const T &e) {
 //            std::cout << e << std::endl;
-            Node *cur = new Node(e);
+            op_scope scope(*this, heap_stats::PUSH, root);
+            Node *cur = new_node(e);
+            root = merge_node(root, cur);
+            len++;
+        }
+
+        void push(T &&e) {
+            op_scope scope(*this, heap_stats::PUSH, root);
+            Node *cur = new_node(std::move(e));
+            root = merge_node(root, cur);
+            len++;
+        }
+
+        /**
+         * construct a new element in place from args and push it.
+         */
+        template<class... Args>
+        void emplace(Args &&...args) {
+            op_scope scope(*this, heap_stats::PUSH, root);
+            Node *cur = new_node(std::forward<Args>(args)...);
             root = merge_node(root, cur);
             len++;
         }
@@ -103,12 +490,26 @@ namespace sjtu {
          */
         void pop() {
             if (empty()) throw container_is_empty();
-            Node *cur = root;
-            root = merge_node(root->left, root->right);
-            delete cur;
+            op_scope scope(*this, heap_stats::POP, root);
+            root = pop_node(root, find_top(root, base_policy()), base_policy());
             len--;
         }
 
+        /**
+         * move the top element out and delete it.
+         * throw container_is_empty if empty() returns true;
+         */
+        T pop_top() {
+            if (empty()) throw container_is_empty();
+            op_scope scope(*this, heap_stats::POP, root);
+            Node *best = find_top(root, base_policy());
+            T res(std::move(best->data));
+            //best已经找好,之后不会再比较被移走的data
+            root = pop_node(root, best, base_policy());
+            len--;
+            return res;
+        }
+
         /**
          * return the number of the elements.
          */
@@ -127,8 +528,12 @@ namespace sjtu {
         /**
          * merge two priority_queues with at least O(logn) complexity.
          * clear the other priority_queue.
+         * other must be ordered the same way, this queue keeps its own comparator.
          */
         void merge(priority_queue &other) {
+            if (this == &other) return;
+            if (pool != other.pool) throw runtime_error();
+            op_scope scope(*this, heap_stats::MERGE, root);
             root = merge_node(root, other.root);
             len += other.len;
 //            clear(other.root);
@@ -138,38 +543,575 @@ namespace sjtu {
             other.root = nullptr;
         }
 
+        /**
+         * merge every queue in [first, last) into this one and clear them.
+         * the roots are melded in balanced pairwise rounds, so each heap takes
+         * part in O(log k) merges instead of folding them one by one.
+         * throw runtime_error if some queue uses another pool.
+         */
+        template<class Iter>
+        void merge_all(Iter first, Iter last) {
+            int k = 1;
+            for (Iter it = first; it != last; ++it, k++) {
+                const priority_queue &other = *it;
+                if (other.pool != pool) throw runtime_error();
+            }
+            op_scope scope(*this, heap_stats::MERGE, root);
+            Node **roots = new Node *[k];
+            int cnt = 0;
+            if (root) roots[cnt++] = root;
+            for (Iter it = first; it != last; ++it) {
+                priority_queue &other = *it;
+                if (&other == this || other.root == nullptr) continue;
+                roots[cnt++] = other.root;
+                len += other.len;
+                other.root = nullptr;
+                other.len = 0;
+            }
+            root = merge_rounds(roots, cnt);
+            delete[] roots;
+        }
+
+        /**
+         * push every element of [first, last).
+         * the batch is built into a small heap first (O(m) pairwise rounds)
+         * and then melded into the queue by one merge.
+         */
+        template<class Iter>
+        void push_range(Iter first, Iter last) {
+            op_scope scope(*this, heap_stats::PUSH, root);
+            Node **nodes = nullptr;
+            int cnt = 0, cap = 0;
+            try {
+                for (; first != last; ++first) {
+                    if (cnt == cap) {
+                        cap = cap ? cap * 2 : 64;
+                        Node **tmp = new Node *[cap];
+                        for (int i = 0; i < cnt; i++) tmp[i] = nodes[i];
+                        delete[] nodes;
+                        nodes = tmp;
+                    }
+                    nodes[cnt] = new_node(*first);
+                    cnt++;
+                }
+            } catch (...) {
+                for (int i = 0; i < cnt; i++) delete_node(nodes[i]);
+                delete[] nodes;
+                throw;
+            }
+            int m = cnt;
+            Node *batch = merge_rounds(nodes, cnt);
+            delete[] nodes;
+            root = merge_node(root, batch);
+            len += m;
+        }
+
+        /**
+         * move the top k elements to out in priority order and delete them.
+         * throw container_is_empty if size() < k, nothing is deleted then.
+         * @return out after the last written element.
+         */
+        template<class OutputIter>
+        OutputIter pop_n(size_t k, OutputIter out) {
+            if (k > size()) throw container_is_empty();
+            op_scope scope(*this, heap_stats::POP, root);
+            for (size_t i = 0; i < k; i++) {
+                Node *best = find_top(root, base_policy());
+                *out = std::move(best->data);
+                ++out;
+                root = pop_node(root, best, base_policy());
+                //out抛异常时已经删掉的元素不能再算在size里
+                len--;
+            }
+            return out;
+        }
+
         //把x和y合并(并没有新建空间,所以之前需要new操作)
-        Node *merge_node(Node *&x, Node *&y) {
+        //统计时记录这次合并走过的节点数,右链长度在整个操作结束后由op_scope记录
+        Node *merge_node(Node *x, Node *y) {
+            this->stat_merge_begin();
+            Node *res = merge_node(x, y, base_policy());
+            this->stat_merge_end();
+            return res;
+        }
+
+        //斜堆: 沿右链合并,每一层都交换左右子树
+        Node *merge_node(Node *&x, Node *&y, skew_heap) {
             if (x == nullptr) return y;
             if (y == nullptr) return x;
+            this->stat_step();
 
             //保证x是较大的那个根(如果要实现小根堆,就改成大于号)
-            if (Compare()(x->data, y->data)) swap<Node *>(x, y);
+            if (comp()(x->data, y->data)) swap<Node *>(x, y);
 
             //交换左右子树
-            x->right = merge_node(x->right, y);
+            x->right = merge_node(x->right, y, skew_heap());
             swap<Node *>(x->left, x->right);
 
             return x;
         }
 
-        //利用递归实现
+        //左偏树: 右链长度不超过 log n,只有 rank(左) < rank(右) 时才交换
+        //rank 为零路径长度,空节点视为 -1
+        Node *merge_node(Node *&x, Node *&y, leftist_heap) {
+            if (x == nullptr) return y;
+            if (y == nullptr) return x;
+            this->stat_step();
+
+            if (comp()(x->data, y->data)) swap<Node *>(x, y);
+
+            x->right = merge_node(x->right, y, leftist_heap());
+            if (npl(x->left) < npl(x->right)) swap<Node *>(x->left, x->right);
+            x->rank = npl(x->right) + 1;
+
+            return x;
+        }
+
+        //二项堆: 两条按度数递增的根链表归并,再把度数相同的相邻两棵树连接起来
+        Node *merge_node(Node *x, Node *y, binomial_heap) {
+            if (x == nullptr) return y;
+            if (y == nullptr) return x;
+
+            Node *head = nullptr, **tail = &head;
+            while (x && y) {
+                this->stat_step();
+                if (x->rank <= y->rank) {
+                    *tail = x;
+                    x = x->right;
+                } else {
+                    *tail = y;
+                    y = y->right;
+                }
+                tail = &((*tail)->right);
+            }
+            *tail = x ? x : y;
+
+            Node *prev = nullptr, *cur = head, *next = cur->right;
+            while (next) {
+                this->stat_step();
+                if (cur->rank != next->rank || (next->right && next->right->rank == cur->rank)) {
+                    prev = cur;
+                    cur = next;
+                } else if (!comp()(cur->data, next->data)) {
+                    cur->right = next->right;
+                    link(next, cur);
+                } else {
+                    if (prev) prev->right = next;
+                    else head = next;
+                    link(cur, next);
+                    cur = next;
+                }
+                next = cur->right;
+            }
+            return head;
+        }
+
+        //删除堆顶best,返回新的根
+        Node *pop_node(Node *t, Node *, skew_heap) {
+            Node *res = merge_node(t->left, t->right);
+            delete_node(t);
+            return res;
+        }
+
+        Node *pop_node(Node *t, Node *, leftist_heap) {
+            Node *res = merge_node(t->left, t->right);
+            delete_node(t);
+            return res;
+        }
+
+        //二项堆: 从根链表中摘下最大的树,把它的儿子倒序后作为新的根链表合并回去
+        Node *pop_node(Node *t, Node *best, binomial_heap) {
+            Node *prev = nullptr;
+            if (best != t) {
+                prev = t;
+                while (prev->right != best) prev = prev->right;
+                prev->right = best->right;
+            } else {
+                t = t->right;
+            }
+
+            Node *children = nullptr, *c = best->left;
+            while (c) {
+                Node *next = c->right;
+                c->right = children;
+                children = c;
+                c = next;
+            }
+            delete_node(best);
+            return merge_node(t, children);
+        }
+
+        Node *find_top(Node *t, skew_heap) const {
+            return t;
+        }
+
+        Node *find_top(Node *t, leftist_heap) const {
+            return t;
+        }
+
+        //二项堆的根链表长度不超过 log n
+        Node *find_top(Node *t, binomial_heap) const {
+            Node *best = t;
+            for (t = t->right; t; t = t->right)
+                if (comp()(best->data, t->data)) best = t;
+            return best;
+        }
+
+    private:
+        //还没有复制的子树src,复制好之后挂到*dst上
+        struct Task {
+            const Node *src;
+            Node **dst;
+        };
+
+        static void push_task(Task *&stack, int &top, int &cap, const Node *src, Node **dst) {
+            if (src == nullptr) return;
+            if (top == cap) {
+                cap = cap ? cap * 2 : 64;
+                Task *tmp = new Task[cap];
+                for (int i = 0; i < top; i++) tmp[i] = stack[i];
+                delete[] stack;
+                stack = tmp;
+            }
+            stack[top].src = src;
+            stack[top++].dst = dst;
+        }
+
+        template<class... Args>
+        Node *new_node(Args &&...args) {
+            Node *t;
+            if (pool == nullptr) {
+                t = new Node(std::forward<Args>(args)...);
+            } else {
+                void *mem = pool->allocate();
+                try {
+                    t = new(mem) Node(std::forward<Args>(args)...);
+                } catch (...) {
+                    pool->deallocate(mem);
+                    throw;
+                }
+            }
+            this->stat_alloc();
+            return t;
+        }
+
+        void delete_node(Node *t) {
+            this->stat_free();
+            if (pool == nullptr) {
+                delete t;
+            } else {
+                t->~Node();
+                pool->deallocate(t);
+            }
+        }
+
+        //复制other的所有节点,this原本是空的
+        //节点很多时,先按层复制最上面几层,把剩下互不相交的子树分给多个线程
+        //pool和统计的计数器都不是线程安全的,这两种情况只能单线程复制;
+        //T的拷贝构造可能读写共享的状态,只有平凡复制的T才并行
+        void copy_from(const priority_queue &other) {
+            int threads = std::thread::hardware_concurrency();
+            if (!std::is_trivially_copyable<T>::value || threads < 2 || other.len < parallel_threshold ||
+                pool || heap_policy<Policy>::stats) {
+                try {
+                    clone(root, other.root);
+                } catch (...) {
+                    clear(root);
+                    throw;
+                }
+                len = other.len;
+                return;
+            }
+
+            //按层展开,直到有足够多的子树可以分
+            int want = threads * 8, head = 0, cnt = 0, cap = want * 4;
+            Task *tasks = new Task[cap];
+            tasks[cnt].src = other.root;
+            tasks[cnt++].dst = &root;
+            try {
+                while (head < cnt && cnt - head < want && cnt + 2 <= cap) {
+                    Task cur = tasks[head++];
+                    Node *x = new_node(*cur.src);
+                    x->left = x->right = nullptr;
+                    *cur.dst = x;
+                    if (cur.src->left) {
+                        tasks[cnt].src = cur.src->left;
+                        tasks[cnt++].dst = &x->left;
+                    }
+                    if (cur.src->right) {
+                        tasks[cnt].src = cur.src->right;
+                        tasks[cnt++].dst = &x->right;
+                    }
+                }
+            } catch (...) {
+                delete[] tasks;
+                clear(root);
+                throw;
+            }
+
+            //子树大小不一,每个线程做完一棵再领下一棵
+            std::atomic<int> next(head);
+            std::atomic<bool> failed(false);
+            std::thread *pool_threads = nullptr;
+            std::exception_ptr error;
+            int started = 0;
+            try {
+                pool_threads = new std::thread[threads];
+                for (; started < threads; started++) {
+                    pool_threads[started] = std::thread([this, tasks, cnt, &next, &failed] {
+                        for (int j = next++; j < cnt; j = next++) {
+                            try {
+                                clone(*tasks[j].dst, tasks[j].src);
+                            } catch (...) {
+                                failed = true;
+                            }
+                        }
+                    });
+                }
+            } catch (...) {
+                //已经启动的线程要先等它们结束,否则析构joinable的thread会terminate
+                error = std::current_exception();
+            }
+            for (int i = 0; i < started; i++) pool_threads[i].join();
+            delete[] pool_threads;
+            delete[] tasks;
+            if (error) {
+                clear(root);
+                std::rethrow_exception(error);
+            }
+            if (failed) {
+                clear(root);
+                throw std::bad_alloc();
+            }
+            len = other.len;
+        }
+
+    public:
+        //每一轮把相邻的两个堆合并,堆的个数减半
+        Node *merge_rounds(Node **roots, int cnt) {
+            while (cnt > 1) {
+                int half = 0;
+                for (int i = 0; i + 1 < cnt; i += 2) roots[half++] = merge_node(roots[i], roots[i + 1]);
+                if (cnt & 1) roots[half++] = roots[cnt - 1];
+                cnt = half;
+            }
+            return cnt ? roots[0] : nullptr;
+        }
+
+        static int npl(const Node *t) {
+            return t ? t->rank : -1;
+        }
+
+        //把度数相同的y挂到x下面,成为x的第一个儿子
+        static void link(Node *y, Node *x) {
+            y->right = x->left;
+            x->left = y;
+            x->rank++;
+        }
+
+        //斜堆可能很不平衡,递归会爆栈
+        //有左儿子就右旋,把树变成一条向右的链,一边走一边删,不需要额外空间
         void clear(Node *&t) {
-            if (t == nullptr) return;
-            clear(t->left);
-            clear(t->right);
-            delete t;
-            t = nullptr;
+            while (t) {
+                if (t->left) {
+                    Node *l = t->left;
+                    t->left = l->right;
+                    l->right = t;
+                    t = l;
+                } else {
+                    Node *r = t->right;
+                    delete_node(t);
+                    t = r;
+                }
+            }
         }
 
+        //用显式栈代替递归: 沿左链一路复制,右子树留在栈里
         void clone(Node *&t, const Node *p) {
-            if (p == nullptr) return;
+            Task *stack = nullptr;
+            int top = 0, cap = 0;
+            push_task(stack, top, cap, p, &t);
+            try {
+                while (top) {
+                    Task cur = stack[--top];
+                    for (const Node *src = cur.src; src; src = src->left) {
+                        Node *x = new_node(*src);
+                        x->left = x->right = nullptr;
+                        *cur.dst = x;
+                        if (src->right) push_task(stack, top, cap, src->right, &x->right);
+                        cur.dst = &x->left;
+                    }
+                }
+            } catch (...) {
+                //已经复制好的部分都挂在t上,交给调用者清理
+                delete[] stack;
+                throw;
+            }
+            delete[] stack;
+        }
+
+    };
+
+/**
+ * yields the elements of many priority_queues and sorted ranges in priority
+ * order without melding or modifying them.
+ * a frontier heap holds every node whose parent has been yielded (heap order
+ * makes it a candidate) and the current position of every range.
+ * ranges must be sorted in the order top() would return them.
+ * the sources must outlive the merge and must not be modified meanwhile.
+ */
+    template<typename T, class Compare = std::less<T>, class Policy = skew_heap, class Iter = const T *>
+    class kway_merge : private compare_holder<Compare> {
+        typedef typename priority_queue<T, Compare, Policy>::Node Node;
+        typedef typename heap_policy<Policy>::type base_policy;
+        typedef compare_holder<Compare> compare_base;
+        using compare_base::comp;
+
+        //node不为空时指向堆中的节点,否则是区间[cur, end)
+        struct Cursor {
+            const Node *node;
+            Iter cur, end;
+        };
+
+    private:
+        Cursor *a;
+        int len, cap;
+
+    public:
+        kway_merge() : a(nullptr), len(0), cap(0) {}
+
+        //有状态的比较器要和各个来源排序时用的一致
+        explicit kway_merge(const Compare &c) : compare_base(c), a(nullptr), len(0), cap(0) {}
+
+        kway_merge(const kway_merge &other) : compare_base(other), a(nullptr), len(other.len), cap(other.len) {
+            if (cap) a = new Cursor[cap];
+            for (int i = 0; i < len; i++) a[i] = other.a[i];
+        }
+
+        kway_merge &operator=(const kway_merge &other) {
+            if (this == &other) return *this;
+            Cursor *tmp = other.len ? new Cursor[other.len] : nullptr;
+            for (int i = 0; i < other.len; i++) tmp[i] = other.a[i];
+            delete[] a;
+            a = tmp;
+            len = cap = other.len;
+            compare_base::operator=(other);
+            return *this;
+        }
+
+        ~kway_merge() {
+            delete[] a;
+        }
+
+        void add(const priority_queue<T, Compare, Policy> &q) {
+            add_roots(q.root, base_policy());
+        }
+
+        void add(Iter first, Iter last) {
+            if (first == last) return;
+            Cursor c;
+            c.node = nullptr;
+            c.cur = first;
+            c.end = last;
+            push(c);
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+        /**
+         * the next element in priority order.
+         * throw container_is_empty if empty() returns true;
+         */
+        const T &top() const {
+            if (empty()) throw container_is_empty();
+            return value(a[0]);
+        }
 
-            t = new Node(p->data);
-            clone(t->left, p->left);
-            clone(t->right, p->right);
+        /**
+         * advance to the next element.
+         * throw container_is_empty if empty() returns true;
+         */
+        void pop() {
+            if (empty()) throw container_is_empty();
+            Cursor c = a[0];
+            a[0] = a[--len];
+            if (len) sift_down(0);
+            if (c.node) {
+                add_children(c.node, base_policy());
+            } else if (++c.cur != c.end) {
+                push(c);
+            }
+        }
+
+    private:
+        static const T &value(const Cursor &c) {
+            return c.node ? c.node->data : *c.cur;
         }
 
+        bool better(int i, int j) const {
+            return comp()(value(a[j]), value(a[i]));
+        }
+
+        void push_node(const Node *t) {
+            if (t == nullptr) return;
+            Cursor c;
+            c.node = t;
+            push(c);
+        }
+
+        void add_roots(const Node *t, skew_heap) {
+            push_node(t);
+        }
+
+        void add_roots(const Node *t, leftist_heap) {
+            push_node(t);
+        }
+
+        //二项堆的根链表中每一棵树都是候选
+        void add_roots(const Node *t, binomial_heap) {
+            for (; t; t = t->right) push_node(t);
+        }
+
+        void add_children(const Node *t, skew_heap) {
+            push_node(t->left);
+            push_node(t->right);
+        }
+
+        void add_children(const Node *t, leftist_heap) {
+            push_node(t->left);
+            push_node(t->right);
+        }
+
+        //左儿子右兄弟: 儿子是从t->left开始的兄弟链
+        void add_children(const Node *t, binomial_heap) {
+            for (t = t->left; t; t = t->right) push_node(t);
+        }
+
+        void push(const Cursor &c) {
+            if (len == cap) {
+                cap = cap ? cap * 2 : 16;
+                Cursor *tmp = new Cursor[cap];
+                for (int i = 0; i < len; i++) tmp[i] = a[i];
+                delete[] a;
+                a = tmp;
+            }
+            a[len] = c;
+            for (int i = len++; i && better(i, (i - 1) / 2); i = (i - 1) / 2)
+                swap<Cursor>(a[i], a[(i - 1) / 2]);
+        }
+
+        void sift_down(int i) {
+            while (1) {
+                int best = i, l = i * 2 + 1, r = i * 2 + 2;
+                if (l < len && better(l, best)) best = l;
+                if (r < len && better(r, best)) best = r;
+                if (best == i) return;
+                swap<Cursor>(a[i], a[best]);
+                i = best;
+            }
+        }
     };
 
 }
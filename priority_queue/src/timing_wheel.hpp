@@ -0,0 +1,376 @@
+#ifndef SJTU_TIMING_WHEEL_HPP
+#define SJTU_TIMING_WHEEL_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * a hierarchical timing wheel: 4 levels of 256 slots cover 2^32 ticks ahead
+ * of the current time, deadlines further away wait in a priority_queue.
+ * schedule and cancel are O(1); advance(now) moves the expired payloads out
+ * in deadline order.
+ * a timer sits in the lowest level whose digit is the first one where its
+ * deadline differs from the current time, and is moved down (cascaded) when
+ * the current time reaches its slot. advance jumps straight to the next
+ * non-empty slot, so idle time costs nothing.
+ */
+    template<typename Payload>
+    class timing_wheel {
+    public:
+        typedef unsigned long long time_type;
+
+    private:
+        enum { LEVELS = 4, BITS = 8, SLOTS = 1 << BITS, WORDS = SLOTS / 64 };
+
+        //槽的哨兵只需要两个指针,不带Payload
+        struct Link {
+            Link *prev, *next;
+        };
+
+        struct Timer : Link {
+            time_type deadline;
+            unsigned long long id; //0表示空闲,回收后id会变,旧的句柄就失效了
+            bool far;              //在overflow队列里,不在链表上
+            int where;             //所在的槽: 第l层第s个是l*SLOTS+s, due链表是-1
+            alignas(Payload) unsigned char buf[sizeof(Payload)];
+
+            Payload &payload() {
+                return *reinterpret_cast<Payload *>(buf);
+            }
+        };
+
+        //overflow队列中的元素,id对不上说明已经被取消了
+        struct Far {
+            time_type deadline;
+            Timer *t;
+            unsigned long long id;
+        };
+
+        struct Later {
+            bool operator()(const Far &a, const Far &b) const {
+                return a.deadline > b.deadline || (a.deadline == b.deadline && a.id > b.id);
+            }
+        };
+
+    public:
+        /**
+         * returned by schedule, stays valid (and harmless) after the timer fired.
+         */
+        struct handle {
+            Timer *t;
+            unsigned long long id;
+
+            handle() : t(nullptr), id(0) {}
+
+            handle(Timer *_t, unsigned long long _id) : t(_t), id(_id) {}
+        };
+
+    private:
+        Link slot[LEVELS][SLOTS];  //每个槽是一个带哨兵的循环双向链表
+        unsigned long long used[LEVELS][WORDS]; //非空的槽
+        Link due;                  //已经到期、等下一次advance取走的
+        priority_queue<Far, Later> overflow;
+        Timer *free_list;          //用完的Timer放回这里,析构时才真正释放
+        time_type cur;
+        unsigned long long next_id;
+        size_t len;
+
+    public:
+        explicit timing_wheel(time_type start = 0) : free_list(nullptr), cur(start), next_id(0), len(0) {
+            for (int l = 0; l < LEVELS; l++) {
+                for (int s = 0; s < SLOTS; s++) slot[l][s].prev = slot[l][s].next = &slot[l][s];
+                for (int w = 0; w < WORDS; w++) used[l][w] = 0;
+            }
+            due.prev = due.next = &due;
+        }
+
+        timing_wheel(const timing_wheel &other) = delete;
+
+        timing_wheel &operator=(const timing_wheel &other) = delete;
+
+        //一个Timer可能同时被overflow中过期的元素引用,所以先全部放回free_list,最后统一释放
+        ~timing_wheel() {
+            while (!overflow.empty()) {
+                Far f = overflow.pop_top();
+                if (f.t->id != f.id) continue;
+                f.t->payload().~Payload();
+                recycle(f.t);
+            }
+            for (int l = 0; l < LEVELS; l++)
+                for (int s = 0; s < SLOTS; s++) destroy_list(&slot[l][s]);
+            destroy_list(&due);
+            while (free_list) {
+                Timer *t = free_list;
+                free_list = static_cast<Timer *>(t->next);
+                delete t;
+            }
+        }
+
+        /**
+         * schedule payload to expire at deadline.
+         * a deadline not after now() expires first on the next advance,
+         * in schedule order.
+         */
+        handle schedule(time_type deadline, const Payload &payload) {
+            Timer *t = new_timer();
+            try {
+                new(t->buf) Payload(payload);
+            } catch (...) {
+                recycle(t);
+                throw;
+            }
+            return place_new(t, deadline);
+        }
+
+        handle schedule(time_type deadline, Payload &&payload) {
+            Timer *t = new_timer();
+            try {
+                new(t->buf) Payload(std::move(payload));
+            } catch (...) {
+                recycle(t);
+                throw;
+            }
+            return place_new(t, deadline);
+        }
+
+        /**
+         * cancel a pending timer in O(1).
+         * @return false if it has already expired or been cancelled.
+         */
+        bool cancel(const handle &h) {
+            Timer *t = h.t;
+            if (t == nullptr || t->id != h.id || h.id == 0) return false;
+            if (!t->far) unlink(t);
+            //overflow里的不用删,取出来时发现id对不上就跳过
+            t->payload().~Payload();
+            recycle(t);
+            len--;
+            return true;
+        }
+
+        /**
+         * move time forward to now and write the payloads of all timers with
+         * deadline <= now to out, in deadline order.
+         * throw runtime_error if now is earlier than the current time.
+         */
+        template<class OutputIter>
+        OutputIter advance(time_type now, OutputIter out) {
+            if (now < cur) throw runtime_error();
+            out = drain(&due, out);
+            while (cur < now) {
+                time_type next = next_event();
+                if (next > now) {
+                    cur = now;
+                    break;
+                }
+                cur = next;
+                //先把上层到期的槽拆到下层,再取走第0层当前槽
+                if ((cur & 0xffffffffull) == 0) pull_overflow();
+                for (int l = LEVELS - 1; l > 0; l--) {
+                    if (cur & ((1ull << (BITS * l)) - 1)) continue;
+                    cascade(l, (int) ((cur >> (BITS * l)) & (SLOTS - 1)));
+                }
+                out = drain_slot(0, (int) (cur & (SLOTS - 1)), out);
+                //拆下来时正好到期的放在due里
+                out = drain(&due, out);
+            }
+            return out;
+        }
+
+        //当前时间
+        time_type now() const {
+            return cur;
+        }
+
+        //还没有到期也没有被取消的定时器个数
+        size_t size() const {
+            return len;
+        }
+
+        bool empty() const {
+            return !len;
+        }
+
+    private:
+        Timer *new_timer() {
+            Timer *t = free_list;
+            if (t) free_list = static_cast<Timer *>(t->next);
+            else t = new Timer;
+            t->id = ++next_id;
+            t->far = false;
+            return t;
+        }
+
+        void recycle(Timer *t) {
+            t->id = 0;
+            t->next = free_list;
+            free_list = t;
+        }
+
+        handle place_new(Timer *t, time_type deadline) {
+            t->deadline = deadline;
+            try {
+                place(t);
+            } catch (...) {
+                t->payload().~Payload();
+                recycle(t);
+                throw;
+            }
+            len++;
+            return handle(t, t->id);
+        }
+
+        //按照和cur第一个不同的8位决定层数,超过32位就放进overflow
+        void place(Timer *t) {
+            if (t->deadline <= cur) {
+                t->where = -1;
+                link(&due, t);
+                return;
+            }
+            time_type diff = t->deadline ^ cur;
+            for (int l = 0; l < LEVELS; l++) {
+                if (diff >> (BITS * (l + 1))) continue;
+                int s = (int) ((t->deadline >> (BITS * l)) & (SLOTS - 1));
+                t->where = l * SLOTS + s;
+                link(&slot[l][s], t);
+                used[l][s >> 6] |= 1ull << (s & 63);
+                return;
+            }
+            Far f;
+            f.deadline = t->deadline;
+            f.t = t;
+            f.id = t->id;
+            overflow.push(f);
+            t->far = true;
+        }
+
+        static void link(Link *head, Timer *t) {
+            t->prev = head->prev;
+            t->next = head;
+            head->prev->next = t;
+            head->prev = t;
+        }
+
+        void unlink(Timer *t) {
+            t->prev->next = t->next;
+            t->next->prev = t->prev;
+            //槽空了就清掉对应的位
+            if (t->where >= 0 && t->next == t->prev) {
+                int l = t->where / SLOTS, s = t->where % SLOTS;
+                used[l][s >> 6] &= ~(1ull << (s & 63));
+            }
+        }
+
+        //第l层在digit之后第一个非空的槽,没有就返回-1
+        int next_slot(int l, int digit) const {
+            for (int s = digit + 1; s < SLOTS;) {
+                unsigned long long w = used[l][s >> 6] >> (s & 63);
+                if (w) return s + __builtin_ctzll(w);
+                s = (s | 63) + 1;
+            }
+            return -1;
+        }
+
+        //下一个需要处理的时刻: 各层下一个非空槽被轮到的时间,以及overflow被拉进来的时间
+        time_type next_event() const {
+            time_type best = ~0ull;
+            for (int l = 0; l < LEVELS; l++) {
+                int s = next_slot(l, (int) ((cur >> (BITS * l)) & (SLOTS - 1)));
+                if (s < 0) continue;
+                time_type high = cur >> (BITS * (l + 1)) << (BITS * (l + 1));
+                time_type at = high | ((time_type) s << (BITS * l));
+                if (at < best) best = at;
+            }
+            if (!overflow.empty()) {
+                time_type at = overflow.top().deadline >> 32 << 32;
+                if (at < best) best = at;
+            }
+            return best;
+        }
+
+        //把overflow中高32位和cur相同的定时器放进轮子
+        void pull_overflow() {
+            while (!overflow.empty() && (overflow.top().deadline >> 32) == (cur >> 32)) {
+                Far f = overflow.pop_top();
+                if (f.t->id != f.id) continue;
+                f.t->far = false;
+                place(f.t);
+            }
+        }
+
+        //第l层的槽s到期了,按新的cur重新放到下层
+        void cascade(int l, int s) {
+            Link *head = &slot[l][s];
+            if (head->next == head) return;
+            Link *t = head->next;
+            head->prev->next = nullptr;
+            head->prev = head->next = head;
+            used[l][s >> 6] &= ~(1ull << (s & 63));
+            while (t) {
+                Link *next = t->next;
+                try {
+                    place(static_cast<Timer *>(t));
+                } catch (...) {
+                    //还没放下去的按原来的顺序接回这个槽
+                    for (; t; t = next) {
+                        next = t->next;
+                        link(head, static_cast<Timer *>(t));
+                    }
+                    used[l][s >> 6] |= 1ull << (s & 63);
+                    throw;
+                }
+                t = next;
+            }
+        }
+
+        //把槽整个接到due的前面再取,写out抛异常时剩下的下一次advance最先取走
+        template<class OutputIter>
+        OutputIter drain_slot(int l, int s, OutputIter out) {
+            Link *head = &slot[l][s];
+            used[l][s >> 6] &= ~(1ull << (s & 63));
+            if (head->next == head) return out;
+            for (Link *t = head->next; t != head; t = t->next) static_cast<Timer *>(t)->where = -1;
+            head->prev->next = due.next;
+            due.next->prev = head->prev;
+            due.next = head->next;
+            head->next->prev = &due;
+            head->prev = head->next = head;
+            return drain(&due, out);
+        }
+
+        //先交给out再摘下来,写out失败时定时器还在链表上
+        template<class OutputIter>
+        OutputIter drain(Link *head, OutputIter out) {
+            while (head->next != head) {
+                Timer *t = static_cast<Timer *>(head->next);
+                *out = std::move(t->payload());
+                t->prev->next = t->next;
+                t->next->prev = t->prev;
+                len--;
+                t->payload().~Payload();
+                recycle(t);
+                ++out;
+            }
+            return out;
+        }
+
+        void destroy_list(Link *head) {
+            while (head->next != head) {
+                Timer *t = static_cast<Timer *>(head->next);
+                head->next = t->next;
+                t->payload().~Payload();
+                recycle(t);
+            }
+            head->prev = head;
+        }
+    };
+
+}
+
+#endif